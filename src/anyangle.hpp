@@ -0,0 +1,114 @@
+﻿#pragma once
+
+#include <cstdlib>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// Спрямление пути по прямой видимости
+// Путь по клеткам заменяется ломаной из отрезков между центрами клеток.
+// Формат прежний - смещения в обратном порядке, но смещение может охватывать
+// произвольное число клеток под любым углом.
+// Модель видимости соответствует передвижению AStar со срезанием углов: отрезок
+// проходим, если свободны все клетки, внутренность которых он пересекает;
+// касание угла клетки препятствием не считается.
+////////////////////////////////////////////////////////////////////////////////
+
+namespace tool
+{
+
+    // Обход клеток, пересекаемых отрезком между центрами (x0, y0) и (x1, y1),
+    // начиная со следующей за стартовой. visit(x, y) возвращает false для прерывания.
+    // Возвращает true, если обход дошёл до конца
+    template <typename F>
+    bool segment_walk(int x0, int y0, int x1, int y1, F&& visit)
+    {
+        const int nx = std::abs(x1 - x0), ny = std::abs(y1 - y0);
+        const int sx = x1 > x0 ? 1 : -1, sy = y1 > y0 ? 1 : -1;
+        int x = x0, y = y0;
+        for (int ix = 0, iy = 0; ix < nx || iy < ny; )
+        {
+            // Сравнение моментов пересечения очередных вертикальной и горизонтальной границ
+            int decision = (1 + 2 * ix) * ny - (1 + 2 * iy) * nx;
+            if (decision == 0)
+            {
+                x += sx; y += sy; ++ix; ++iy; // Точно через угол
+            } else if (decision < 0)
+            {
+                x += sx; ++ix;
+            } else
+            {
+                y += sy; ++iy;
+            }
+            if (!visit(x, y))
+                return false;
+        }
+        return true;
+    }
+
+    template <typename TMap>
+    bool line_of_sight(const TMap& map, int x0, int y0, int x1, int y1)
+    {
+        return segment_walk(x0, y0, x1, y1, [&map](int x, int y) { return !map.isobstacle(x, y); });
+    }
+
+    // Спрямление пути из смещений (в обратном порядке), начинающегося в start_p
+    template <typename TMap, typename TCoords, typename TPath>
+    void path_smooth(TPath& path, const TMap& map, const TCoords& start_p)
+    {
+        if (path.size() < 2)
+            return;
+        // Опорные точки по ходу движения. Буферы свои у каждого потока
+        // и не освобождаются между вызовами
+        static thread_local std::vector<TCoords> cells, kept;
+        cells.clear();
+        cells.reserve(path.size() + 1);
+        cells.push_back(start_p);
+        for (auto it = path.rbegin(); it != path.rend(); ++it)
+        {
+            TCoords c = cells.back();
+            c.x += it->x;
+            c.y += it->y;
+            cells.push_back(c);
+        }
+        // Жадно тянем отрезок от последней оставленной точки, пока она видна
+        kept.clear();
+        kept.push_back(start_p);
+        for (size_t i = 2; i < cells.size(); ++i)
+        {
+            const TCoords& a = kept.back();
+            if (!line_of_sight(map, a.x, a.y, cells[i].x, cells[i].y))
+                kept.push_back(cells[i - 1]);
+        }
+        kept.push_back(cells.back());
+        path.clear();
+        for (size_t i = kept.size() - 1; i > 0; --i)
+        {
+            TCoords ofs;
+            ofs.x = kept[i].x - kept[i - 1].x;
+            ofs.y = kept[i].y - kept[i - 1].y;
+            path.push_back(ofs);
+        }
+    }
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright(c) 2017 https://github.com/mrprint
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
@@ -0,0 +1,109 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+
+////////////////////////////////////////////////////////////////////////////////
+// Плотная битовая карта препятствий: один бит на клетку
+// Строки дополнены рамкой из занятых клеток, поэтому окрестность 3x3 любой
+// клетки поля извлекается без проверок границ: по сдвигу и маске на строку.
+////////////////////////////////////////////////////////////////////////////////
+
+namespace tool
+{
+
+    // Биты маски окрестности: (dy + 1) * 3 + (dx + 1)
+    enum NeighbourBit : unsigned {
+        nbNW = 1u << 0, nbN = 1u << 1, nbNE = 1u << 2,
+        nbW = 1u << 3, nbC = 1u << 4, nbE = 1u << 5,
+        nbSW = 1u << 6, nbS = 1u << 7, nbSE = 1u << 8
+    };
+
+    template <std::size_t H, std::size_t W>
+    class Bitboard
+    {
+        static constexpr std::size_t STRIDE = (W + 2 + 63) / 64; // Слов на строку с рамкой
+
+        std::array<std::uint64_t, (H + 2) * STRIDE> words;
+
+    public:
+
+        Bitboard() { clear(); }
+
+        // Все клетки поля свободны, рамка занята
+        void clear()
+        {
+            words.fill(0);
+            for (std::size_t k = 0; k < STRIDE; ++k)
+            {
+                words[k] = ~std::uint64_t(0);
+                words[(H + 1) * STRIDE + k] = ~std::uint64_t(0);
+            }
+            for (std::size_t y = 1; y <= H; ++y)
+            {
+                bit_put(0, y, true);
+                bit_put(W + 1, y, true);
+            }
+        }
+
+        bool test(int x, int y) const
+        {
+            std::size_t bx = static_cast<std::size_t>(x) + 1, by = static_cast<std::size_t>(y) + 1;
+            return (words[by * STRIDE + bx / 64] >> (bx % 64)) & 1;
+        }
+
+        void set(int x, int y, bool value)
+        {
+            bit_put(static_cast<std::size_t>(x) + 1, static_cast<std::size_t>(y) + 1, value);
+        }
+
+        // Маска занятости окрестности 3x3 (см. NeighbourBit). За пределами поля - занято
+        unsigned neighbours(int x, int y) const
+        {
+            const std::size_t bx = static_cast<std::size_t>(x); // Левый столбец окрестности в координатах с рамкой
+            const std::size_t k = bx / 64, sh = bx % 64;
+            const std::uint64_t *row = &words[static_cast<std::size_t>(y) * STRIDE + k];
+            unsigned mask = 0;
+            for (unsigned r = 0; r < 3; ++r, row += STRIDE)
+            {
+                std::uint64_t v = row[0] >> sh;
+                if (sh > 61)
+                    v |= row[1] << (64 - sh);
+                mask |= static_cast<unsigned>(v & 7) << (r * 3);
+            }
+            return mask;
+        }
+
+    private:
+
+        void bit_put(std::size_t bx, std::size_t by, bool value)
+        {
+            std::uint64_t& w = words[by * STRIDE + bx / 64];
+            const std::uint64_t b = std::uint64_t(1) << (bx % 64);
+            w = value ? (w | b) : (w & ~b);
+        }
+    };
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright(c) 2017 https://github.com/mrprint
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
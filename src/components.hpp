@@ -0,0 +1,367 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include "gridpolicies.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Разметка связных областей свободных клеток
+// Клетки одной области несут общую метку, поэтому заведомо недостижимая цель
+// распознаётся сравнением двух чисел, без поиска пути. Разметка поддерживается
+// при каждой смене проходимости клетки:
+// - освободившаяся клетка присоединяется к соседним областям; если их несколько,
+//   меньшие перемечаются в крупнейшую;
+// - для ставшей препятствием клетки сначала проверяется, связаны ли её свободные
+//   соседи в пределах окрестности 3x3. Обычно связаны, и разметка не меняется.
+//   Иначе от каждой группы соседей одновременно идут волны; встретившиеся волны
+//   объединяются, а исчерпавшаяся без встреч получает новую метку. Работа
+//   пропорциональна размеру отколовшихся частей, а не всего поля.
+////////////////////////////////////////////////////////////////////////////////
+
+namespace tool
+{
+
+    template <
+        std::size_t H, std::size_t W, // Размерность карты
+        typename TNeighbourhood = NeighbourhoodEight // Связность, та же, что и у поиска
+    >
+    class Components
+    {
+        static constexpr unsigned NONE = 0; // Метка препятствия
+
+        struct Wave // Волна от группы соседей при проверке раскола
+        {
+            std::vector<unsigned> cells; // Пройденные клетки; с head - фронт
+            std::size_t head;
+            unsigned set; // Представитель объединения встретившихся волн
+        };
+
+        std::vector<unsigned> labels;
+        std::vector<unsigned> sizes; // Размер области по метке
+        std::vector<unsigned> spare; // Освободившиеся метки
+        std::vector<unsigned> marks; // Поколение последней проверки раскола, коснувшейся клетки
+        std::vector<unsigned char> owners; // Волна, коснувшаяся клетки
+        unsigned epoch;
+
+    public:
+
+        Components() : labels(H * W), marks(H * W, 0), owners(H * W), epoch(0) { reset(); }
+
+        // Все клетки свободны
+        void reset()
+        {
+            std::fill(labels.begin(), labels.end(), 1u);
+            sizes.assign(2, 0);
+            sizes[1] = static_cast<unsigned>(H * W);
+            spare.clear();
+        }
+
+        // Уведомление о смене проходимости клетки; карта уже изменена
+        template <typename TMap>
+        void cell_changed(const TMap& map, int x, int y)
+        {
+            const unsigned ci = index2d(x, y);
+            if (map.isobstacle(x, y))
+            {
+                if (labels[ci] != NONE)
+                    cell_blocked(map, x, y);
+            } else
+            {
+                if (labels[ci] == NONE)
+                    cell_freed(map, x, y);
+            }
+        }
+
+        // Цель заведомо недостижима: она занята или лежит в другой области.
+        // Занятая стартовая клетка метки не имеет и ничего не решает
+        bool separated(int x0, int y0, int x1, int y1) const
+        {
+            const unsigned a = labels[index2d(x0, y0)], b = labels[index2d(x1, y1)];
+            return b == NONE || (a != NONE && a != b);
+        }
+
+        unsigned label_get(int x, int y) const { return labels[index2d(x, y)]; }
+
+        // Ближайшая по октильной мере к (x1, y1) клетка области, в которой
+        // лежит (x0, y0). Клетки перебираются кольцами вокруг (x1, y1), пока
+        // кольцо не окажется дальше найденной, - без поиска пути и без обхода
+        // области. false - стартовая клетка занята
+        template <typename TCoords>
+        bool nearest_in_area(int x0, int y0, int x1, int y1, TCoords& found) const
+        {
+            const unsigned a = labels[index2d(x0, y0)];
+            if (a == NONE)
+                return false;
+            found.x = x0;
+            found.y = y0;
+            int best = HeuristicOctile()(found, TCoords{ x1, y1 });
+            auto probe = [&](int x, int y)
+            {
+                if (x < 0 || y < 0 || x >= static_cast<int>(W) || y >= static_cast<int>(H) || labels[index2d(x, y)] != a)
+                    return;
+                TCoords c{ x, y };
+                int cost = HeuristicOctile()(c, TCoords{ x1, y1 });
+                if (cost < best)
+                {
+                    best = cost;
+                    found = c;
+                }
+            };
+            const int rmax = static_cast<int>(std::max(H, W));
+            for (int r = 0; r < rmax && GRID_STEP_COST * r < best; ++r)
+            {
+                if (r == 0)
+                {
+                    probe(x1, y1);
+                    continue;
+                }
+                for (int d = -r; d <= r; ++d)
+                {
+                    probe(x1 + d, y1 - r);
+                    probe(x1 + d, y1 + r);
+                }
+                for (int d = -r + 1; d < r; ++d)
+                {
+                    probe(x1 - r, y1 + d);
+                    probe(x1 + r, y1 + d);
+                }
+            }
+            return true;
+        }
+
+    private:
+
+        template <typename TMap>
+        void cell_freed(const TMap& map, int x, int y)
+        {
+            // Крупнейшая из соседних областей поглощает остальные
+            unsigned adj[8], cells[8], n = 0; // Метки соседних областей и клетки в них
+            TNeighbourhood::expand(map, x, y, static_cast<int>(W), static_cast<int>(H), [&](int dx, int dy, int)
+            {
+                unsigned ui = index2d(x + dx, y + dy);
+                if (std::find(adj, adj + n, labels[ui]) == adj + n)
+                {
+                    adj[n] = labels[ui];
+                    cells[n++] = ui;
+                }
+            });
+            unsigned host;
+            if (n == 0)
+            {
+                host = label_new();
+            } else
+            {
+                host = *std::max_element(adj, adj + n, [this](unsigned a, unsigned b) { return sizes[a] < sizes[b]; });
+                for (unsigned k = 0; k < n; ++k)
+                    if (adj[k] != host)
+                        relabel(map, cells[k], host);
+            }
+            labels[index2d(x, y)] = host;
+            ++sizes[host];
+        }
+
+        template <typename TMap>
+        void cell_blocked(const TMap& map, int x, int y)
+        {
+            const unsigned ci = index2d(x, y), old = labels[ci];
+            labels[ci] = NONE;
+            if (--sizes[old] == 0)
+            {
+                spare.push_back(old);
+                return;
+            }
+            // Группы соседей, связанных в пределах окрестности
+            unsigned seeds[8], n = 0;
+            epoch_next();
+            TNeighbourhood::expand(map, x, y, static_cast<int>(W), static_cast<int>(H), [&](int dx, int dy, int)
+            {
+                unsigned si = index2d(x + dx, y + dy);
+                if (marks[si] == epoch)
+                    return; // Уже в одной из групп
+                seeds[n++] = si;
+                group_mark(map, x, y, si);
+            });
+            if (n < 2)
+                return;
+            split(map, old, seeds, n);
+        }
+
+        // Отметка клеток окрестности (x, y), связанных с si в её пределах
+        template <typename TMap>
+        void group_mark(const TMap& map, int x, int y, unsigned si)
+        {
+            unsigned stack[8], top = 0;
+            marks[si] = epoch;
+            stack[top++] = si;
+            while (top > 0)
+            {
+                unsigned vi = stack[--top];
+                int vx = static_cast<int>(vi % W), vy = static_cast<int>(vi / W);
+                TNeighbourhood::expand(map, vx, vy, static_cast<int>(W), static_cast<int>(H), [&](int dx, int dy, int)
+                {
+                    int ux = vx + dx, uy = vy + dy;
+                    if (ux < x - 1 || ux > x + 1 || uy < y - 1 || uy > y + 1)
+                        return;
+                    unsigned ui = index2d(ux, uy);
+                    if (marks[ui] != epoch)
+                    {
+                        marks[ui] = epoch;
+                        stack[top++] = ui;
+                    }
+                });
+            }
+        }
+
+        // Одновременные волны от групп соседей. Пока не исчерпаны все объединения,
+        // кроме одного, каждая волна по очереди делает шаг
+        template <typename TMap>
+        void split(const TMap& map, unsigned old, const unsigned *seeds, unsigned n)
+        {
+            Wave waves[8];
+            epoch_next();
+            for (unsigned k = 0; k < n; ++k)
+            {
+                waves[k].cells.assign(1, seeds[k]);
+                waves[k].head = 0;
+                waves[k].set = k;
+                marks[seeds[k]] = epoch;
+                owners[seeds[k]] = static_cast<unsigned char>(k);
+            }
+            auto find = [&waves](unsigned k)
+            {
+                while (waves[k].set != k)
+                    k = waves[k].set;
+                return k;
+            };
+            bool done[8] = {}; // Объединение выделено в отдельную область
+            for (unsigned alive = n; alive > 1; )
+            {
+                for (unsigned k = 0; k < n; ++k)
+                {
+                    Wave& w = waves[k];
+                    if (w.head == w.cells.size() || done[find(k)])
+                        continue;
+                    unsigned vi = w.cells[w.head++];
+                    int vx = static_cast<int>(vi % W), vy = static_cast<int>(vi / W);
+                    TNeighbourhood::expand(map, vx, vy, static_cast<int>(W), static_cast<int>(H), [&](int dx, int dy, int)
+                    {
+                        unsigned ui = index2d(vx + dx, vy + dy);
+                        if (marks[ui] != epoch)
+                        {
+                            marks[ui] = epoch;
+                            owners[ui] = static_cast<unsigned char>(k);
+                            w.cells.push_back(ui);
+                            return;
+                        }
+                        unsigned a = find(k), b = find(owners[ui]);
+                        if (a != b)
+                        {
+                            waves[b].set = a; // Встреча: области по-прежнему едины
+                            --alive;
+                        }
+                    });
+                }
+                // Исчерпавшиеся объединения откалываются
+                for (unsigned k = 0; k < n && alive > 1; ++k)
+                {
+                    if (find(k) != k || done[k])
+                        continue;
+                    bool exhausted = true;
+                    for (unsigned j = 0; j < n && exhausted; ++j)
+                        if (find(j) == k && waves[j].head < waves[j].cells.size())
+                            exhausted = false;
+                    if (!exhausted)
+                        continue;
+                    unsigned l = label_new();
+                    for (unsigned j = 0; j < n; ++j)
+                    {
+                        if (find(j) != k)
+                            continue;
+                        for (auto ui : waves[j].cells)
+                            labels[ui] = l;
+                        sizes[l] += static_cast<unsigned>(waves[j].cells.size());
+                    }
+                    sizes[old] -= sizes[l];
+                    done[k] = true;
+                    --alive;
+                }
+            }
+        }
+
+        // Перенос области, содержащей клетку si, в область to
+        template <typename TMap>
+        void relabel(const TMap& map, unsigned si, unsigned to)
+        {
+            const unsigned from = labels[si];
+            std::vector<unsigned> stack(1, si);
+            labels[si] = to;
+            while (!stack.empty())
+            {
+                unsigned vi = stack.back();
+                stack.pop_back();
+                int vx = static_cast<int>(vi % W), vy = static_cast<int>(vi / W);
+                TNeighbourhood::expand(map, vx, vy, static_cast<int>(W), static_cast<int>(H), [&](int dx, int dy, int)
+                {
+                    unsigned ui = index2d(vx + dx, vy + dy);
+                    if (labels[ui] == from)
+                    {
+                        labels[ui] = to;
+                        stack.push_back(ui);
+                    }
+                });
+            }
+            sizes[to] += sizes[from];
+            sizes[from] = 0;
+            spare.push_back(from);
+        }
+
+        unsigned label_new()
+        {
+            if (!spare.empty())
+            {
+                unsigned l = spare.back();
+                spare.pop_back();
+                return l;
+            }
+            sizes.push_back(0);
+            return static_cast<unsigned>(sizes.size() - 1);
+        }
+
+        void epoch_next()
+        {
+            if (++epoch == 0)
+            {
+                std::fill(marks.begin(), marks.end(), 0u);
+                epoch = 1;
+            }
+        }
+
+        static unsigned index2d(int x, int y)
+        {
+            return static_cast<unsigned>(y * W + x);
+        }
+    };
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright(c) 2017 https://github.com/mrprint
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
@@ -0,0 +1,148 @@
+﻿#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+// Сопрограммы поверх фоновых заданий (C++20)
+// Task - сопрограмма, которая запускается сразу и живёт сама по себе, пока не
+// завершится. TickScheduler возобновляет ожидающие сопрограммы в очередном
+// такте основного потока: после следующего такта (next_tick) или по готовности
+// фонового задания (background). Так игровая логика может дождаться пути или
+// расчёта, не опрашивая флаги каждый кадр, и выстроить несколько шагов подряд.
+// Без поддержки сопрограмм компилятором TOOL_COROUTINES не определяется, и
+// остаётся только интерфейс на опросе.
+////////////////////////////////////////////////////////////////////////////////
+
+#if defined(__has_include)
+#if __has_include(<coroutine>) && defined(__cpp_impl_coroutine)
+#define TOOL_COROUTINES 1
+#endif
+#endif
+
+#if defined(TOOL_COROUTINES)
+
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <vector>
+#include <optional>
+#include <utility>
+#include <type_traits>
+
+namespace tool
+{
+
+    // Сопрограмма без результата. Кадр освобождается по её завершении
+    struct Task
+    {
+        struct promise_type
+        {
+            Task get_return_object() noexcept { return Task(); }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() noexcept {}
+            void unhandled_exception() noexcept { std::terminate(); }
+        };
+    };
+
+    class TickScheduler
+    {
+        std::mutex mtx;
+        std::vector<std::coroutine_handle<>> queued; // К возобновлению в следующем такте
+        std::vector<std::coroutine_handle<>> running; // Возобновляемые сейчас; ёмкость сохраняется
+
+    public:
+
+        // Постановка сопрограммы на возобновление. Любой поток
+        void schedule(std::coroutine_handle<> h)
+        {
+            std::lock_guard<std::mutex> lck(mtx);
+            queued.push_back(h);
+        }
+
+        // Возобновление поставленных сопрограмм. Основной поток, раз в такт.
+        // Поставленные по ходу возобновляются уже в следующем такте
+        void resume_ready()
+        {
+            {
+                std::lock_guard<std::mutex> lck(mtx);
+                running.swap(queued);
+            }
+            for (auto h : running)
+                h.resume();
+            running.clear();
+        }
+
+        // co_await next_tick() - продолжение в следующем такте
+        auto next_tick()
+        {
+            struct Awaiter
+            {
+                TickScheduler& scheduler;
+                bool await_ready() const noexcept { return false; }
+                void await_suspend(std::coroutine_handle<> h) { scheduler.schedule(h); }
+                void await_resume() const noexcept {}
+            };
+            return Awaiter{ *this };
+        }
+
+        // co_await background(executor, f) - f() выполняется исполнителем,
+        // сопрограмма продолжается с её результатом в очередном такте
+        template <typename Executor, typename F>
+        auto background(Executor& executor, F f)
+        {
+            using R = std::invoke_result_t<F&>;
+            using Storage = std::conditional_t<std::is_void_v<R>, bool, std::optional<R>>;
+            struct Awaiter
+            {
+                TickScheduler& scheduler;
+                Executor& executor;
+                F f;
+                Storage result;
+
+                bool await_ready() const noexcept { return false; }
+                void await_suspend(std::coroutine_handle<> h)
+                {
+                    // Захватываются лишь указатель и дескриптор: задание
+                    // умещается в std::function без выделения памяти
+                    executor.post([this, h]
+                    {
+                        if constexpr (std::is_void_v<R>)
+                            f();
+                        else
+                            result.emplace(f());
+                        scheduler.schedule(h);
+                    });
+                }
+                R await_resume()
+                {
+                    if constexpr (!std::is_void_v<R>)
+                        return std::move(*result);
+                }
+            };
+            return Awaiter{ *this, executor, std::move(f), Storage() };
+        }
+    };
+
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright(c) 2017 https://github.com/mrprint
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
@@ -1,70 +1,239 @@
 ﻿#include "settings.hpp"
-#include <thread>
 #include <mutex>
+#include <future>
+#include <chrono>
+#include <memory>
+#include <atomic>
+#include <algorithm>
 #include "coworker_async.hpp"
 #include "world.hpp"
 #include "spaces.hpp"
 
 using namespace std;
 
+Executor the_executor;
 Coworker the_coworker;
 
-static FieldsAStar a_star;
+static mutex planner_mutex; // Охраняет инкрементальные планировщики
+static FieldsPlanner planner;
+// На очень больших полях одиночные запросы делятся между ядрами. На прочих
+// планировщик не создаётся вовсе
+static FieldsHDAStar& hdastar_get()
+{
+    static FieldsHDAStar hdastar{ HDA_THREADS };
+    return hdastar;
+}
+// Для запросов, которые основному планировщику не по силам: многоцелевых
+// и к отрезанным целям (ищет ближайшую к ним достижимую клетку), - A* без
+// состояния. Он создаётся на каждое задание с таблицей ориентиров снимка,
+// рабочие пространства берутся из общего запаса
+static tool::WorkspacePool<FieldsAStar::Workspace> astar_spaces;
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void Coworker::start()
+PathTicket Coworker::path_find(FieldSnapshot field, tool::DeskPosition st, tool::DeskPosition fn)
+{
+    auto ticket = slot_acquire();
+    if (ticket.id == 0)
+        return ticket;
+    PathSlot& slot = (*channel)[ticket.slot];
+    slot.field = move(field);
+    slot.start_p = st;
+    slot.finish_p = fn;
+    slot.goals.clear();
+    slot_post(ticket.slot);
+    return ticket;
+}
+
+PathTicket Coworker::path_find(FieldSnapshot field, tool::DeskPosition st, const Goals &_goals)
 {
-    w_thread = thread{ &Coworker::body, this };
+    auto ticket = slot_acquire();
+    if (ticket.id == 0)
+        return ticket;
+    PathSlot& slot = (*channel)[ticket.slot];
+    slot.field = move(field);
+    slot.start_p = slot.finish_p = st;
+    slot.goals = _goals; // Ёмкость вектора ячейки переиспользуется
+    slot_post(ticket.slot);
+    return ticket;
 }
 
-void Coworker::stop()
+void Coworker::path_cancel(const PathTicket &ticket)
 {
+    if (!channel || ticket.id == 0)
+        return;
+    PathSlot& slot = (*channel)[ticket.slot];
+    if (slot.result.id == ticket.id) // Ячейка ещё не отдана другому запросу
+        slot.cancel.store(true, memory_order_relaxed);
+}
+
+PathTicket Coworker::slot_acquire()
+{
+    if (!channel)
+    {
+        channel.reset(new PathChannel(the_executor.threads_get() + 1));
+        ready.reserve(PATH_SLOTS);
+    }
+    unsigned i;
+    if (!channel->acquire(i))
     {
-        unique_lock<mutex> lck(mp_mutex);
-        flags_set(cwSTART | cwDONE);
-        start_cond.notify_one();
+        // Все ячейки в работе. Готовые отменённые освобождаются сразу,
+        // прочие и ожидаемые сопрограммами ждут results_take(). Ждать здесь
+        // нельзя: их освобождает этот же поток
+        for (unsigned j; channel->take(j); )
+        {
+            PathSlot& slot = (*channel)[j];
+            if ((slot.result.cancelled || slot.cancel.load(memory_order_relaxed)) && !slot_awaited(slot))
+                channel->release(j);
+            else
+                ready.push_back(j);
+        }
+        if (!channel->acquire(i))
+            return PathTicket{ 0, 0 }; // Занято
     }
-    w_thread.join();
+    PathSlot& slot = (*channel)[i];
+    slot.result.id = ++last_id;
+    slot.cancel.store(false, memory_order_relaxed);
+#if defined(TOOL_COROUTINES)
+    slot.waiter = nullptr;
+#endif
+    return PathTicket{ last_id, i };
 }
 
-void Coworker::path_find_request(const Field &_field, tool::DeskPosition st, tool::DeskPosition fn)
+void Coworker::slot_post(unsigned i)
 {
-    if (flags_get(cwREADY))
+    // Захватываются лишь указатель и номер: задание умещается в std::function
+    // без выделения памяти
+    the_executor.post([this, i]
     {
-        field = &_field;
-        start_p = st;
-        finish_p = fn;
-        flags_clear(cwREADY);
-    }
+        PathSlot& slot = (*channel)[i];
+        path_compute(slot);
+        slot.field.reset(); // Буфер снимка возвращается в запас, не дожидаясь основного потока
+        channel->publish(the_executor.worker_index(), i);
+    });
+}
+
+void Coworker::cell_changed(tool::DeskPosition pos, unsigned long revision)
+{
+    unique_lock<mutex> lck(mp_mutex);
+    changes.push_back(Change{ pos, revision });
+}
+
+void Coworker::field_reset(unsigned long revision)
+{
+    unique_lock<mutex> lck(mp_mutex);
+    changes.clear();
+    reset_pending = true;
+    reset_revision = revision;
+}
+
+shared_ptr<const FieldsLandmarks> Coworker::landmarks_get(const FieldSnapshot &snapshot)
+{
+    unique_lock<mutex> lck(lm_mutex);
+    if (landmarks_next.valid() && landmarks_next.wait_for(chrono::seconds(0)) == future_status::ready)
+        landmarks = landmarks_next.get();
+    if (landmarks && landmarks->revision_get() == snapshot->revision_get())
+        return landmarks;
+    if (!landmarks_next.valid() && (!landmarks || landmarks->revision_get() < snapshot->revision_get()))
     {
-        unique_lock<mutex> lck(mp_mutex);
-        flags_set(cwSTART);
-        start_cond.notify_one();
+        landmarks_next = the_executor.submit([snapshot]
+        {
+            auto table = make_shared<FieldsLandmarks>(snapshot->revision_get());
+            table->build(*snapshot);
+            return shared_ptr<const FieldsLandmarks>(move(table));
+        });
     }
+    return nullptr;
 }
 
-void Coworker::body()
+void Coworker::path_compute(PathSlot &slot)
 {
-    while (true)
+    const Field &field = *slot.field;
+    const atomic<bool> *cancel = &slot.cancel;
+    PathResult &result = slot.result; // Номер запроса не трогаем: его читает основной поток
+    result.path.clear();
+    result.goal = slot.finish_p;
+    result.cancelled = cancel->load(memory_order_relaxed);
+    if (result.cancelled)
+        return; // Отменён, пока стоял в очереди
+    request_narrow(field, slot.start_p, slot.finish_p, slot.goals);
+    const FieldsAStar astar(FieldsHeuristic(landmarks_get(slot.field))); // Без таблицы - октильная оценка
+    const tool::DeskPosition start_p = slot.start_p, finish_p = slot.finish_p;
+    result.goal = finish_p;
+    thread_local Path ofs; // Смещения от планировщика, до сжатия. Ёмкость остаётся потоку
+    ofs.clear();
+    bool found;
+    if (!slot.goals.empty())
     {
-        start_wait();
-        if (flags_get(cwDONE))
-            break;
-        if (!flags_get(cwREADY))
+        auto ws = astar_spaces.acquire();
+        ws->cancel = cancel;
+        found = astar.search_multi_ofs(*ws, ofs, field, start_p, slot.goals, result.goal);
+        if (!found && PATH_NEAREST_FALLBACK)
         {
-            path.clear();
-            a_star.search_ofs(path, *field, start_p, finish_p);
-            flags_set(cwREADY);
+            astar.search_result_nearest_ofs(*ws, ofs);
+            result.goal = ws->nearest_p; // Путь ведёт туда, а не к одной из целей
+            found = true;
+        }
+    } else if (PATH_NEAREST_FALLBACK && field.unreachable(start_p, finish_p))
+    {
+        // Сюда попадает лишь запрос с занятого старта: прочие отрезанные цели
+        // уже заменены ближайшими достижимыми
+        auto ws = astar_spaces.acquire();
+        ws->cancel = cancel;
+        if (!astar.search_nearest_ofs(*ws, ofs, field, start_p, finish_p))
+            result.goal = ws->nearest_p;
+        found = true; // Путь к ближайшей клетке есть всегда, пусть и пустой
+    } else
+    {
+        unique_lock<mutex> lck(planner_mutex);
+        if (cancel->load(memory_order_relaxed))
+        {
+            result.cancelled = true; // Отменён, пока ждал планировщик
+            return;
+        }
+        bool synced = changes_apply(field.revision_get());
+        if constexpr (WORLD_DIM >= HDA_MIN_DIM)
+        {
+            found = hdastar_get().search_ofs(ofs, field, start_p, finish_p, cancel);
+        } else if (synced)
+        {
+            found = planner.search_ofs(ofs, field, start_p, finish_p, cancel);
+        } else
+        {
+            // Снимок старше поля, по которому уже обновлён планировщик
+            lck.unlock();
+            auto ws = astar_spaces.acquire();
+            ws->cancel = cancel;
+            found = astar.search_ofs(*ws, ofs, field, start_p, finish_p);
         }
     }
+    result.cancelled = cancel->load(memory_order_relaxed);
+    if (result.cancelled)
+        return; // Путь, если и найден, уже никому не нужен
+    if (found && PATH_SMOOTH)
+        tool::path_smooth(ofs, field, start_p);
+    result.path.assign_ofs(ofs); // Передаётся основному потоку уже сжатым, в буфере ячейки
 }
 
-void Coworker::start_wait()
+bool Coworker::changes_apply(unsigned long revision)
 {
+    if (revision < planner_revision)
+        return false;
     unique_lock<mutex> lck(mp_mutex);
-    while (!flags_get(cwSTART)) start_cond.wait(lck);
-    flags_clear(cwSTART);
+    if (reset_pending)
+    {
+        if (revision < reset_revision)
+            return false; // Снимок прежнего поля
+        planner.reset();
+        reset_pending = false;
+    }
+    // Изменения новее снимка остаются до задания с более свежим снимком
+    auto later = stable_partition(changes.begin(), changes.end(), [revision](const Change& c) { return c.revision <= revision; });
+    for (auto it = changes.begin(); it != later; ++it)
+        planner.cell_changed(it->pos.x, it->pos.y);
+    changes.erase(changes.begin(), later);
+    planner_revision = revision;
+    return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1,52 +1,134 @@
 ﻿#pragma once
 
-#include <thread>
 #include <mutex>
-#include <atomic>
-#include <condition_variable>
+#include <vector>
+#include <future>
+#include <memory>
+#include <chrono>
+#include <utility>
+#include "executor.hpp"
+#include "coroutines.hpp"
 #include "world.hpp"
 #include "spaces.hpp"
 
-// Вспомогательный поток расчета пути
-// Изначально был задействован для преодоления на скорую руку сверхнизкой производительности
-// использовавшейся имплементации поиска пути, а сейчас оставлен "на всякий случай"
+using Executor = tool::ThreadPool;
+extern Executor the_executor; // Общий пул фоновых заданий
+
+// Расчёт путей в пуле фоновых потоков
+// Каждый запрос - отдельное задание со своим результатом, поэтому новый запрос
+// не ждёт завершения прежних. Инкрементальный планировщик один, и задания
+// пользуются им по очереди; прочие поиски идут параллельно.
+// Отменённый запрос снимается ещё до поиска или прерывает его на ходу.
+// Каждое задание читает свой неизменяемый снимок поля, так что поле можно
+// менять, не дожидаясь окончания поисков. Запрос и результат живут в ячейке
+// канала путей, которую задание возвращает основному потоку по номеру
 class Coworker
 {
-    std::atomic<unsigned> flags;
-    std::mutex mp_mutex;
-    std::condition_variable start_cond;
-    std::thread w_thread;
+    struct Change
+    {
+        tool::DeskPosition pos;
+        unsigned long revision; // Ревизия поля после изменения
+    };
 
-    const Field *field;
-    tool::DeskPosition start_p, finish_p;
-    Path path;
+    std::mutex mp_mutex;
+    std::vector<Change> changes; // Изменения поля, ещё не переданные планировщику
+    bool reset_pending;
+    unsigned long reset_revision; // Ревизия поля, с которой планировщик начинается заново
+    unsigned long planner_revision; // Ревизия, с которой согласован планировщик. Под planner_mutex
+    std::mutex lm_mutex; // Охраняет таблицы ориентиров: их запрашивают задания
+    std::shared_ptr<const FieldsLandmarks> landmarks; // Последняя построенная таблица ориентиров
+    std::future<std::shared_ptr<const FieldsLandmarks>> landmarks_next; // Строящаяся в фоне
+    std::unique_ptr<PathChannel> channel; // Создаётся при первом запросе, когда пул уже запущен
+    std::vector<unsigned> ready; // Готовые ячейки, вынутые из канала в ожидании свободной
+    unsigned long last_id; // Номер последнего запроса
+#if defined(TOOL_COROUTINES)
+    tool::TickScheduler ticks; // Сопрограммы, ждущие такта или фонового задания
+#endif
 
 public:
 
-    enum Flags {
-        cwREADY = 1,
-        cwSTART = 2,
-        cwDONE = 4
-    };
-
-    Coworker() : field(nullptr) { flags.store(cwREADY); }
-    void start();
-    void stop();
-    void flags_set(unsigned _flags) { flags.fetch_or(_flags); }
-    void flags_clear(unsigned _flags) { flags.fetch_and(~_flags); }
-    bool flags_get(unsigned _flags) { return (flags.load() & _flags) == _flags; }
-    // Запрос на расчёт пути
-    void path_find_request(const Field&, tool::DeskPosition, tool::DeskPosition);
-    // Получение результата
-    void path_read(Path& _path) const { _path = path; }
+    Coworker() : reset_pending(false), reset_revision(0), planner_revision(0), last_id(0) {}
+    // Запрос на расчёт пути. Если все PATH_SLOTS ячеек заняты живыми (не
+    // отменёнными и не забранными) запросами, он не принимается: номер 0
+    PathTicket path_find(FieldSnapshot, tool::DeskPosition, tool::DeskPosition);
+    // Запрос на расчёт пути к ближайшей из целей
+    PathTicket path_find(FieldSnapshot, tool::DeskPosition, const Goals&);
+    // Отмена запроса. Его результат не будет отдан
+    void path_cancel(const PathTicket&);
+    // Передача готовых путей обработчику handler(PathResult&), вызывается
+    // основным потоком. Отменённые запросы пропускаются
+    template <typename F>
+    void results_take(F handler)
+    {
+        if (channel)
+        {
+            for (auto i : ready)
+                result_pass(i, handler);
+            ready.clear();
+            for (unsigned i; channel->take(i); )
+                result_pass(i, handler);
+        }
+#if defined(TOOL_COROUTINES)
+        ticks.resume_ready();
+#endif
+    }
+    // Ожидание готового пути не дольше timeout вместо опроса каждый кадр.
+    // false - время истекло
+    bool results_wait(std::chrono::microseconds timeout) { return channel && (!ready.empty() || channel->wait_for(timeout)); }
+#if defined(TOOL_COROUTINES)
+    // co_await path_wait(ticket) - результат запроса в сопрограмме, которая
+    // продолжается в results_take(). Ждать запрос может лишь одна сопрограмма
+    PathAwait path_wait(const PathTicket &ticket) { return PathAwait{ (*channel)[ticket.slot] }; }
+    // co_await next_tick() - продолжение в следующем вызове results_take()
+    auto next_tick() { return ticks.next_tick(); }
+    // co_await background(f) - f() выполняется фоновым заданием, сопрограмма
+    // продолжается с её результатом в results_take()
+    template <typename F>
+    auto background(F f) { return ticks.background(the_executor, std::move(f)); }
+#endif
+    // Продвижение расчёта, вызывается каждый кадр. Пул справляется сам
+    void update() { }
+    // Уведомление об изменении проходимости клетки; ревизия - после изменения
+    void cell_changed(tool::DeskPosition, unsigned long);
+    // Уведомление о полной смене поля; ревизия - нового поля
+    void field_reset(unsigned long);
 
 private:
 
-    // Тело потока
-    // Реализованная механика не учитывает возможные изменения на поле во время расчета, 
-    // поэтому они должны явно блокироваться на соответствующих участках
-    void body();
-    void start_wait();
+    // Ячейка под новый запрос; номер 0 - свободных нет
+    PathTicket slot_acquire();
+    // Постановка задания по заполненной ячейке
+    void slot_post(unsigned);
+    // Тело задания расчёта пути по снимку поля ячейки
+    void path_compute(PathSlot&);
+
+    template <typename F>
+    void result_pass(unsigned i, F& handler)
+    {
+        PathSlot& slot = (*channel)[i];
+        bool cancelled = slot.result.cancelled || slot.cancel.load(std::memory_order_relaxed);
+#if defined(TOOL_COROUTINES)
+        if (slot.waiter)
+        {
+            // Сопрограмма забирает результат до своей следующей приостановки
+            slot.result.cancelled = cancelled;
+            std::exchange(slot.waiter, nullptr).resume();
+            channel->release(i);
+            return;
+        }
+#endif
+        if (!cancelled)
+            handler(slot.result);
+        channel->release(i);
+    }
+
+    // Передача планировщику изменений вплоть до ревизии снимка.
+    // false - состояние планировщика уже новее снимка, и искать по снимку им нельзя
+    bool changes_apply(unsigned long);
+    // Таблица ориентиров для ревизии снимка или nullptr, если она ещё строится.
+    // Устаревшая таблица заменяется построенной в фоне по тому же снимку.
+    // Любой поток
+    std::shared_ptr<const FieldsLandmarks> landmarks_get(const FieldSnapshot&);
 };
 
 extern Coworker the_coworker;
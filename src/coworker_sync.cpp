@@ -1,20 +1,214 @@
 ﻿#include "settings.hpp"
+#include <chrono>
+#include <memory>
+#include <atomic>
 #include "coworker_sync.hpp"
 #include "world.hpp"
 
 using namespace std;
 
+Executor the_executor;
 Coworker the_coworker;
 
-static FieldsAStar a_star;
+static FieldsAStar planner; // Пошаговый, чтобы укладываться в бюджет кадра
+static FieldsAStar::Workspace workspace;
+static Path ofs; // Смещения от планировщика, до сжатия
+static shared_ptr<const FieldsLandmarks> landmarks; // Построенная таблица ориентиров
+static unique_ptr<FieldsLandmarks> landmarks_next; // Строящаяся в свободных от поиска кадрах
+
+// Таблица ориентиров для ревизии поля или nullptr, если она ещё не готова
+static shared_ptr<const FieldsLandmarks> landmarks_get(const Field& field)
+{
+    return landmarks && landmarks->revision_get() == field.revision_get() ? landmarks : nullptr;
+}
+
+// Построение в пределах того же бюджета кадра, что и у поиска
+static void landmarks_advance(const Field& field)
+{
+    if (landmarks_get(field))
+        return;
+    if (!landmarks_next || landmarks_next->revision_get() != field.revision_get())
+        landmarks_next.reset(new FieldsLandmarks(field.revision_get()));
+    auto deadline = chrono::steady_clock::now() + chrono::microseconds(PATH_SLICE_US);
+    bool built;
+    do
+    {
+        built = landmarks_next->build_step(field, PATH_SLICE_STEPS);
+    } while (!built && chrono::steady_clock::now() < deadline);
+    if (built)
+        landmarks = move(landmarks_next);
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void Coworker::path_find_request(const Field &_field, tool::DeskPosition st, tool::DeskPosition fn)
+PathTicket Coworker::path_find(FieldSnapshot _field, tool::DeskPosition st, tool::DeskPosition fn)
+{
+    auto ticket = slot_acquire();
+    if (ticket.id == 0)
+        return ticket;
+    PathSlot& slot = channel[ticket.slot];
+    slot.field = move(_field);
+    slot.start_p = st;
+    slot.finish_p = fn;
+    slot.goals.clear();
+    request_narrow(*slot.field, slot.start_p, slot.finish_p, slot.goals);
+    request_push(ticket.slot);
+    return ticket;
+}
+
+PathTicket Coworker::path_find(FieldSnapshot _field, tool::DeskPosition st, const Goals &_goals)
+{
+    auto ticket = slot_acquire();
+    if (ticket.id == 0)
+        return ticket;
+    PathSlot& slot = channel[ticket.slot];
+    slot.field = move(_field);
+    slot.start_p = slot.finish_p = st;
+    slot.goals = _goals; // Ёмкость вектора ячейки переиспользуется
+    request_narrow(*slot.field, slot.start_p, slot.finish_p, slot.goals);
+    request_push(ticket.slot);
+    return ticket;
+}
+
+void Coworker::path_cancel(const PathTicket &ticket)
+{
+    if (ticket.id == 0)
+        return;
+    PathSlot& slot = channel[ticket.slot];
+    if (slot.result.id == ticket.id) // Ячейка ещё не отдана другому запросу
+        slot.cancel.store(true, memory_order_relaxed);
+}
+
+PathTicket Coworker::slot_acquire()
+{
+    unsigned i;
+    if (!channel.acquire(i))
+    {
+        // Все ячейки заняты. Готовые отменённые освобождаются сразу, прочие
+        // и ожидаемые сопрограммами ждут results_take(). Досчитывать поиски
+        // ради свободной ячейки нельзя - это вышло бы за бюджет кадра
+        requests_prune();
+        for (unsigned j; channel.take(j); )
+        {
+            PathSlot& slot = channel[j];
+            if ((slot.result.cancelled || slot.cancel.load(memory_order_relaxed)) && !slot_awaited(slot))
+                channel.release(j);
+            else
+                ready.push_back(j);
+        }
+        if (!channel.acquire(i))
+            return PathTicket{ 0, 0 }; // Занято
+    }
+    PathSlot& slot = channel[i];
+    slot.result.id = ++last_id;
+    slot.cancel.store(false, memory_order_relaxed);
+#if defined(TOOL_COROUTINES)
+    slot.waiter = nullptr;
+#endif
+    return PathTicket{ last_id, i };
+}
+
+void Coworker::request_push(unsigned i)
+{
+    field = channel[i].field;
+    requests_prune();
+    requests.push_back(i);
+    if (requests.size() == 1)
+        search_begin(); // Первый срез - в очередном update()
+}
+
+void Coworker::requests_prune()
+{
+    bool front = !requests.empty() && channel[requests.front()].cancel.load(memory_order_relaxed);
+    for (auto it = requests.begin(); it != requests.end(); )
+    {
+        PathSlot& slot = channel[*it];
+        if (!slot.cancel.load(memory_order_relaxed))
+        {
+            ++it;
+            continue;
+        }
+        slot.result.path.clear();
+        slot.result.goal = slot.start_p;
+        slot.result.cancelled = true;
+        slot.field.reset();
+        channel.publish(0, *it);
+        it = requests.erase(it);
+    }
+    if (front && !requests.empty())
+        search_begin();
+}
+
+void Coworker::search_begin()
+{
+    PathSlot& slot = channel[requests.front()];
+    planner.heuristic_set(FieldsHeuristic(landmarks_get(*slot.field)));
+    if (slot.goals.empty())
+        planner.search_begin(workspace, slot.start_p, slot.finish_p);
+    else
+        planner.search_begin_multi(workspace, slot.start_p, slot.goals);
+}
+
+bool Coworker::search_advance()
+{
+    PathSlot& slot = channel[requests.front()];
+    const Field& front = *slot.field;
+    auto deadline = chrono::steady_clock::now() + chrono::microseconds(PATH_SLICE_US);
+    FieldsAStar::SearchStatus status;
+    do
+    {
+        status = planner.search_step(workspace, front, PATH_SLICE_STEPS);
+    } while (status == FieldsAStar::ssRUNNING && chrono::steady_clock::now() < deadline);
+    if (status == FieldsAStar::ssRUNNING)
+        return false; // Продолжим в следующем кадре
+    PathResult &result = slot.result;
+    result.goal = workspace.finish_p; // Для нескольких целей - достигнутая
+    ofs.clear();
+    if (status == FieldsAStar::ssFOUND)
+        planner.search_result_ofs(workspace, ofs);
+    else if (PATH_NEAREST_FALLBACK)
+    {
+        planner.search_result_nearest_ofs(workspace, ofs); // Та же волна уже нашла ближайшую к цели клетку
+        result.goal = workspace.nearest_p;
+    }
+    if (PATH_SMOOTH)
+        tool::path_smooth(ofs, front, workspace.start_p);
+    result.path.assign_ofs(ofs);
+    result.cancelled = false;
+    slot.field.reset();
+    channel.publish(0, requests.front());
+    requests.pop_front();
+    if (!requests.empty())
+        search_begin();
+    return true;
+}
+
+void Coworker::update()
+{
+    if (!field)
+        return;
+    requests_prune();
+    if (requests.empty())
+    {
+        landmarks_advance(*field); // Поиска нет - достраиваем ориентиры
+        return;
+    }
+    search_advance();
+}
+
+void Coworker::field_reset(unsigned long)
 {
-    path.clear();
-    a_star.search_ofs(&path, _field, st, fn);
-    flags_set(cwREADY);
+    // Незавершённые поиски относятся к прежнему полю: их пути пусты
+    for (auto i : requests)
+    {
+        PathSlot& slot = channel[i];
+        slot.result.path.clear();
+        slot.result.goal = slot.start_p;
+        slot.result.cancelled = false;
+        slot.field.reset();
+        channel.publish(0, i);
+    }
+    requests.clear();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1,32 +1,110 @@
 ﻿#pragma once
 
+#include <deque>
+#include <vector>
+#include <chrono>
+#include <utility>
+#include "executor.hpp"
+#include "coroutines.hpp"
 #include "world.hpp"
 
-// Вспомогательный объект для расчета пути
-// Имитирует взаимодействие с рабочим потоком
+using Executor = tool::InlineExecutor;
+extern Executor the_executor; // Задания выполняются сразу при постановке
+
+// Расчёт путей в основном потоке, по частям в каждом кадре
+// Запросы обслуживаются по очереди; запрос и результат живут в ячейке канала
+// путей, как и у фонового варианта, только производитель здесь один.
+// Отменённые запросы снимаются с очереди, не дожидаясь своего кадра.
+// Каждый запрос ищет по своему снимку поля
 class Coworker
 {
-    unsigned flags;
-    Path path;
+    PathChannel channel{ 1 };
+    std::deque<unsigned> requests; // Ячейки запросов по порядку; первая - обсчитываемая
+    std::vector<unsigned> ready; // Готовые ячейки, вынутые из канала в ожидании свободной
+    unsigned long last_id; // Номер последнего запроса
+#if defined(TOOL_COROUTINES)
+    tool::TickScheduler ticks; // Сопрограммы, ждущие такта или фонового задания
+#endif
+    FieldSnapshot field; // Снимок последнего запроса; по нему достраиваются ориентиры
 
 public:
 
-    enum Flags {
-        cwREADY = 1,
-        cwSTART = 2,
-        cwDONE = 4
-    };
-
-    Coworker() : flags(cwREADY) { }
-    void start() { }
-    void stop() { }
-    void flags_set(unsigned _flags) { flags |= _flags; }
-    void flags_clear(unsigned _flags) { flags &= ~_flags; }
-    bool flags_get(unsigned _flags) { return (flags & _flags) == _flags; }
-    // Запрос на расчёт пути
-    void path_find_request(const Field&, tool::DeskPosition, tool::DeskPosition);
-    // Получение результата
-    void path_read(Path& _path) { _path.swap(path); }
+    Coworker() : last_id(0) { }
+    // Запрос на расчёт пути. Если все PATH_SLOTS ячеек заняты живыми (не
+    // отменёнными и не забранными) запросами, он не принимается: номер 0
+    PathTicket path_find(FieldSnapshot, tool::DeskPosition, tool::DeskPosition);
+    // Запрос на расчёт пути к ближайшей из целей
+    PathTicket path_find(FieldSnapshot, tool::DeskPosition, const Goals&);
+    // Отмена запроса. Его результат не будет отдан
+    void path_cancel(const PathTicket&);
+    // Передача готовых путей обработчику handler(PathResult&).
+    // Отменённые запросы пропускаются
+    template <typename F>
+    void results_take(F handler)
+    {
+        for (auto i : ready)
+            result_pass(i, handler);
+        ready.clear();
+        for (unsigned i; channel.take(i); )
+            result_pass(i, handler);
+#if defined(TOOL_COROUTINES)
+        ticks.resume_ready();
+#endif
+    }
+    // Готовый путь есть - true. Расчёт идёт в update(), ждать здесь некого
+    bool results_wait(std::chrono::microseconds) { return !ready.empty() || channel.wait_for(std::chrono::microseconds(0)); }
+#if defined(TOOL_COROUTINES)
+    // co_await path_wait(ticket) - результат запроса в сопрограмме, которая
+    // продолжается в results_take(). Ждать запрос может лишь одна сопрограмма
+    PathAwait path_wait(const PathTicket &ticket) { return PathAwait{ channel[ticket.slot] }; }
+    // co_await next_tick() - продолжение в следующем вызове results_take()
+    auto next_tick() { return ticks.next_tick(); }
+    // co_await background(f) - f() выполняется фоновым заданием, сопрограмма
+    // продолжается с её результатом в results_take()
+    template <typename F>
+    auto background(F f) { return ticks.background(the_executor, std::move(f)); }
+#endif
+    // Продвижение расчёта, вызывается каждый кадр
+    void update();
+    // Уведомление об изменении проходимости клетки. Обсчитываемые поиски
+    // идут по своим снимкам, а устаревший путь запрашивается заново
+    void cell_changed(tool::DeskPosition, unsigned long) { }
+    // Уведомление о полной смене поля
+    void field_reset(unsigned long);
+
+private:
+
+    // Ячейка под новый запрос; номер 0 - свободных нет
+    PathTicket slot_acquire();
+    // Постановка заполненной ячейки в очередь
+    void request_push(unsigned);
+    // Снятие отменённых запросов. Если снят обсчитываемый, поиск начинается
+    // по следующему
+    void requests_prune();
+    // Начало поиска по первому запросу очереди
+    void search_begin();
+    // Один срез поиска по первому запросу. true - запрос завершён и отдан в канал
+    bool search_advance();
+
+    template <typename F>
+    void result_pass(unsigned i, F& handler)
+    {
+        PathSlot& slot = channel[i];
+        bool cancelled = slot.result.cancelled || slot.cancel.load(std::memory_order_relaxed);
+#if defined(TOOL_COROUTINES)
+        if (slot.waiter)
+        {
+            // Сопрограмма забирает результат до своей следующей приостановки
+            slot.result.cancelled = cancelled;
+            std::exchange(slot.waiter, nullptr).resume();
+            channel.release(i);
+            return;
+        }
+#endif
+        if (!cancelled)
+            handler(slot.result);
+        channel.release(i);
+    }
 };
 
 extern Coworker the_coworker;
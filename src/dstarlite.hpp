@@ -0,0 +1,330 @@
+﻿#pragma once
+
+#include <cstdlib>
+#include <limits>
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include "openlist.hpp"
+#include "gridpolicies.hpp"
+
+// Инкрементальный планировщик D* Lite
+// Хранит состояние поиска между запросами: при смене препятствий пересчитываются
+// лишь затронутые вершины, при перемещении старта - только смещение ключей.
+// Полная инициализация выполняется лишь при смене цели.
+// Модель передвижения та же, что и у AStar: вход в клетку-препятствие запрещен,
+// срезание углов допускается, шаг по прямой стоит 10, по диагонали - 19.
+template<
+    size_t H, size_t W, // Размерность карты
+    typename TCoords, // Тип координат, предоставляющий члены "x" и "y". Со знаком
+    typename TMap, // Карта. Предоставляет "isobstacle(x, y)"
+    typename TPath = std::vector<TCoords> // Возвращаемый путь, предоставляющий push_back
+>
+class DStarLite
+{
+    using TWeight = int;
+
+    static constexpr TWeight INF = std::numeric_limits<TWeight>::max() / 4;
+    static constexpr TWeight STEP_COST = tool::GRID_STEP_COST;
+    static constexpr TWeight DIAG_COST = tool::GRID_DIAG_COST;
+    static constexpr unsigned CANCEL_PERIOD = 8; // Шагов между проверками флага отмены
+
+    struct Node // Атрибуты позиции
+    {
+        TWeight g, rhs;
+        TWeight k1, k2; // Ключ в открытом списке
+        unsigned heap_idx;
+        bool opened;
+    };
+
+    struct NodePtr
+    {
+        Node *pn;
+        unsigned idx;
+        NodePtr() noexcept { /* NO MEMBERS INIT */ };
+        NodePtr(Node *nodes, unsigned i) noexcept : pn(&nodes[i]), idx(i) {}
+        bool operator> (const NodePtr& r) const { return pn->k1 > r.pn->k1 || (pn->k1 == r.pn->k1 && pn->k2 > r.pn->k2); }
+        bool operator== (const NodePtr& r) const { return pn == r.pn; }
+        unsigned& heap_pos() const { return pn->heap_idx; }
+    };
+
+    static constexpr struct { int x, y; TWeight d; } dirs[] =
+    { { -1, -1, DIAG_COST },{ 0, -1, STEP_COST },{ 1, -1, DIAG_COST },{ -1, 0, STEP_COST },
+      { 1, 0, STEP_COST },{ -1, 1, DIAG_COST },{ 0, 1, STEP_COST },{ 1, 1, DIAG_COST } };
+
+    std::unique_ptr<Node[]> nodes;
+    tool::IndexedOpenList<NodePtr> opened;
+    std::vector<unsigned> changed; // Клетки, изменившиеся после последнего поиска
+    TPath forward; // Спуск к цели в прямом порядке; ёмкость сохраняется между поисками
+    TCoords start_p, last_p, finish_p;
+    TWeight km;
+    bool initialized;
+
+public:
+
+    DStarLite() : nodes(new Node[H * W]), km(0), initialized(false) {}
+
+    // Уведомление о смене проходимости клетки
+    void cell_changed(int x, int y)
+    {
+        if (initialized && inbound(x, y))
+            changed.push_back(index2d(x, y));
+    }
+
+    // Сброс накопленного состояния (например, при полной смене карты)
+    void reset()
+    {
+        initialized = false;
+        changed.clear();
+    }
+
+    // Получить смещения (в обратном порядке). Поиск, прерванный флагом отмены,
+    // возвращает false; накопленное состояние остаётся согласованным
+    // и доводится при следующем запросе
+    bool search_ofs(TPath& path, const TMap& map, const TCoords& _start_p, const TCoords& _finish_p,
+        const std::atomic<bool> *cancel = nullptr)
+    {
+        if (!initialized || _finish_p.x != finish_p.x || _finish_p.y != finish_p.y)
+        {
+            init(_start_p, _finish_p);
+        } else
+        {
+            start_p = _start_p;
+            km += cost_estimate(last_p, start_p);
+            last_p = start_p;
+            for (auto ci : changed)
+            {
+                int x = static_cast<int>(ci % W), y = static_cast<int>(ci / W);
+                for (auto& dir : dirs)
+                {
+                    int sx = x - dir.x, sy = y - dir.y;
+                    if (!inbound(sx, sy))
+                        continue;
+                    auto si = index2d(sx, sy);
+                    if (si != index2d(finish_p.x, finish_p.y))
+                        nodes[si].rhs = rhs_calc(map, sx, sy);
+                    vertex_update(si);
+                }
+            }
+        }
+        changed.clear();
+        if (!compute(map, cancel))
+            return false;
+        return get_path_ofs(path, map);
+    }
+
+private:
+
+    void init(const TCoords& _start_p, const TCoords& _finish_p)
+    {
+        for (size_t i = 0; i < H * W; ++i)
+        {
+            nodes[i].g = nodes[i].rhs = INF;
+            nodes[i].opened = false;
+        }
+        opened.clear();
+        km = 0;
+        start_p = last_p = _start_p;
+        finish_p = _finish_p;
+        auto fi = index2d(finish_p.x, finish_p.y);
+        nodes[fi].rhs = 0;
+        vertex_update(fi);
+        initialized = true;
+    }
+
+    void key_calc(unsigned i, TWeight& k1, TWeight& k2) const
+    {
+        TCoords p; p.x = static_cast<int>(i % W); p.y = static_cast<int>(i / W);
+        k2 = std::min(nodes[i].g, nodes[i].rhs);
+        k1 = k2 >= INF ? INF : k2 + cost_estimate(start_p, p) + km;
+    }
+
+    static bool key_less(TWeight a1, TWeight a2, TWeight b1, TWeight b2)
+    {
+        return a1 < b1 || (a1 == b1 && a2 < b2);
+    }
+
+    void vertex_update(unsigned i)
+    {
+        Node& n = nodes[i];
+        NodePtr np(nodes.get(), i);
+        if (n.g != n.rhs)
+        {
+            TWeight k1, k2;
+            key_calc(i, k1, k2);
+            if (n.opened)
+            {
+                opened.update(np, [k1, k2](NodePtr& a) { a.pn->k1 = k1; a.pn->k2 = k2; });
+            } else
+            {
+                n.k1 = k1; n.k2 = k2;
+                n.opened = true;
+                opened.push(np);
+            }
+        } else if (n.opened)
+        {
+            opened.remove(np);
+            n.opened = false;
+        }
+    }
+
+    // Наименьшая стоимость достижения цели через соседей
+    TWeight rhs_calc(const TMap& map, int x, int y) const
+    {
+        TWeight best = INF;
+        for (auto& dir : dirs)
+        {
+            int nx = x + dir.x, ny = y + dir.y;
+            if (!inbound(nx, ny) || map.isobstacle(nx, ny))
+                continue;
+            TWeight g = nodes[index2d(nx, ny)].g;
+            if (g < INF && g + dir.d < best)
+                best = g + dir.d;
+        }
+        return best;
+    }
+
+    // Каждый шаг оставляет в открытом списке все несогласованные вершины,
+    // поэтому прерваться можно между любыми шагами. false - прерван
+    bool compute(const TMap& map, const std::atomic<bool> *cancel)
+    {
+        auto si = index2d(start_p.x, start_p.y);
+        auto fi = index2d(finish_p.x, finish_p.y);
+        for (unsigned step = 1; !opened.empty(); ++step)
+        {
+            if (step % CANCEL_PERIOD == 0 && cancel && cancel->load(std::memory_order_relaxed))
+                return false;
+            TWeight sk1, sk2;
+            key_calc(si, sk1, sk2);
+            NodePtr top = opened.top();
+            if (!key_less(top.pn->k1, top.pn->k2, sk1, sk2) && nodes[si].rhs <= nodes[si].g)
+                break;
+            Node& u = *top.pn;
+            int ux = static_cast<int>(top.idx % W), uy = static_cast<int>(top.idx / W);
+            TWeight k1, k2;
+            key_calc(top.idx, k1, k2);
+            if (key_less(u.k1, u.k2, k1, k2))
+            {
+                opened.update(top, [k1, k2](NodePtr& a) { a.pn->k1 = k1; a.pn->k2 = k2; });
+                continue;
+            }
+            bool free = !map.isobstacle(ux, uy);
+            if (u.g > u.rhs)
+            {
+                u.g = u.rhs;
+                opened.remove(top);
+                u.opened = false;
+                if (!free)
+                    continue; // В препятствие входить нельзя - предшественники не меняются
+                for (auto& dir : dirs)
+                {
+                    int px = ux - dir.x, py = uy - dir.y;
+                    if (!inbound(px, py))
+                        continue;
+                    auto pi = index2d(px, py);
+                    if (pi != fi && u.g + dir.d < nodes[pi].rhs)
+                    {
+                        nodes[pi].rhs = u.g + dir.d;
+                        vertex_update(pi);
+                    }
+                }
+            } else
+            {
+                TWeight g_old = u.g;
+                u.g = INF;
+                if (top.idx != fi)
+                    u.rhs = rhs_calc(map, ux, uy);
+                vertex_update(top.idx);
+                if (!free)
+                    continue;
+                for (auto& dir : dirs)
+                {
+                    int px = ux - dir.x, py = uy - dir.y;
+                    if (!inbound(px, py))
+                        continue;
+                    auto pi = index2d(px, py);
+                    if (pi != fi && g_old < INF && nodes[pi].rhs == g_old + dir.d)
+                    {
+                        nodes[pi].rhs = rhs_calc(map, px, py);
+                        vertex_update(pi);
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    // Спуск от старта к цели по наименьшим оценкам
+    bool get_path_ofs(TPath& path, const TMap& map)
+    {
+        auto si = index2d(start_p.x, start_p.y);
+        if (nodes[si].rhs >= INF)
+            return false;
+        forward.clear();
+        int x = start_p.x, y = start_p.y;
+        for (size_t steps = 0; (x != finish_p.x || y != finish_p.y) && steps < H * W; ++steps)
+        {
+            TWeight best = INF;
+            int bdx = 0, bdy = 0;
+            for (auto& dir : dirs)
+            {
+                int nx = x + dir.x, ny = y + dir.y;
+                if (!inbound(nx, ny) || map.isobstacle(nx, ny))
+                    continue;
+                TWeight g = nodes[index2d(nx, ny)].g;
+                if (g < INF && g + dir.d < best)
+                {
+                    best = g + dir.d;
+                    bdx = dir.x; bdy = dir.y;
+                }
+            }
+            if (best >= INF)
+                return false;
+            TCoords p; p.x = bdx; p.y = bdy;
+            forward.push_back(p);
+            x += bdx; y += bdy;
+        }
+        if (x != finish_p.x || y != finish_p.y)
+            return false;
+        path.insert(path.end(), forward.rbegin(), forward.rend());
+        return true;
+    }
+
+    static unsigned index2d(int x, int y)
+    {
+        return static_cast<unsigned>(y * W + x);
+    }
+
+    // Октильная оценка, согласованная со стоимостями шагов
+    static TWeight cost_estimate(const TCoords& a, const TCoords& b)
+    {
+        return static_cast<TWeight>(tool::HeuristicOctile()(a, b));
+    }
+
+    static bool inbound(int x, int y)
+    {
+        return x >= 0 && x < static_cast<int>(W) && y >= 0 && y < static_cast<int>(H);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright(c) 2017 https://github.com/mrprint
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
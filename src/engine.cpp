@@ -163,8 +163,15 @@ void Engine::input_process()
             case sf::Keyboard::F11:
                 chmode = true;
                 break;
+            case sf::Keyboard::X:
+                controls.set(csEXITKEY);
+                break;
             }
             break;
+        case sf::Event::KeyReleased:
+            if (evt.key.code == sf::Keyboard::X)
+                controls.reset(csEXITKEY);
+            break;
         case sf::Event::MouseButtonPressed:
             mouse_p = ScreenPosition(evt.mouseButton.x, evt.mouseButton.y);
             switch (evt.mouseButton.button)
@@ -202,12 +209,14 @@ void Engine::update(sf::Time tdelta)
     // Для антифликинга
     static bool lb_down = false;
     static bool rb_down = false;
+    static bool x_down = false;
 
     if (!window->isOpen())
         return;
     auto dt = tdelta.asSeconds();
     if (dt > MAX_TIME_FRACT)
         dt = MAX_TIME_FRACT; // Замедляем время, если машина не успевает считать
+    the_coworker.update(); // Продвигаем расчёт пути
 
     if (the_world.state != gsINPROGRESS)
     {
@@ -244,9 +253,9 @@ void Engine::update(sf::Time tdelta)
 
     if (controls.test(csLMBUTTON) && the_world.state == gsINPROGRESS)
     {
-        if (!the_world.character->path_requested && the_coworker.flags_get(Coworker::cwREADY) && !lb_down)
+        if (!lb_down)
         {
-            // Будем идти в указанную позицию
+            // Будем идти в указанную позицию; обсчитываемый путь отменяется
             path_change(DeskPosition(mouse_p));
             lb_down = true;
         }
@@ -255,24 +264,32 @@ void Engine::update(sf::Time tdelta)
     if (controls.test(csRMBUTTON) && the_world.state == gsINPROGRESS)
     {
 
-        if (!the_world.character->path_requested && the_coworker.flags_get(Coworker::cwREADY) && !rb_down)
+        // Фоновые поиски читают свои снимки поля, поэтому менять его можно всегда
+        if (!rb_down)
         {
             // Пытаемся изменить состояние ячейки "свободна"/"препятствие"
             if (cell_flip(DeskPosition(mouse_p)))
             {
-                // При необходимости обсчитываем изменения пути
-                if (the_world.character->way.path.size() > 0)
-                    the_world.character->way_new_request(the_world.character->way.target);
+                // При необходимости обсчитываем изменения пути; обсчитываемый
+                // по прежнему снимку путь заменяется
+                if (!the_world.character->way.path.empty() || the_world.character->path_requested)
+                    the_world.character->way_renew();
             }
             rb_down = true;
         }
     } else
         rb_down = false;
-    if (the_world.character->path_requested && the_coworker.flags_get(Coworker::cwREADY))
+    if (controls.test(csEXITKEY) && the_world.state == gsINPROGRESS)
     {
-        the_world.character->path_requested = false;
-        the_world.character->way_new_process();
-    }
+        if (!x_down)
+        {
+            // Идём к выходу по готовому полю потока
+            the_world.character->way_exit();
+            x_down = true;
+        }
+    } else
+        x_down = false;
+    the_coworker.results_take([](PathResult& result) { the_world.character->way_new_process(result); });
     the_world.move_do(dt); // Рассчитываем изменения
     sounds_play(); // Воспроизводим звуки
 }
@@ -361,10 +378,11 @@ bool Engine::cell_flip(DeskPosition md)
     auto dp = DeskPosition(the_world.character->position);
     if (md.x < 0 || md.x >= WORLD_DIM || md.y < 0 || md.y >= WORLD_DIM || (md.x == dp.x && md.y == dp.y))
         return false;
-    if (the_world.field[md].attribs.test(Cell::atrOBSTACLE))
-        the_world.field[md].attribs.reset(Cell::atrOBSTACLE);
-    else
-        the_world.field[md].attribs.set(Cell::atrOBSTACLE);
+    bool blocked = !the_world.field.isobstacle(md.x, md.y);
+    the_world.field.obstacle_set(md, blocked);
+    the_world.paths.cell_changed(md, blocked, the_world.field.revision_get());
+    the_world.exit_flow.cell_changed(the_world.field, md.x, md.y);
+    the_coworker.cell_changed(md, the_world.field.revision_get());
     return true;
 }
 
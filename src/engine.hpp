@@ -36,6 +36,7 @@ class Engine
     enum ControlState {
         csLMBUTTON,
         csRMBUTTON,
+        csEXITKEY, // Идти к ближайшему выходу
         _csEND
     };
 
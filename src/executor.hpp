@@ -0,0 +1,197 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////////////////
+// Исполнители фоновых заданий
+// ThreadPool - пул потоков с ограниченной очередью, в которую ставят задания
+// любые потоки. InlineExecutor - то же без потоков, для однопоточной сборки:
+// задание выполняется сразу при постановке. Интерфейс у обоих общий:
+// submit() возвращает результат задания через std::future, post() ставит
+// задание без результата и, если оно умещается в std::function без выделения
+// памяти, обходится без выделений вовсе.
+////////////////////////////////////////////////////////////////////////////////
+
+namespace tool
+{
+
+    template <typename F>
+    using JobResult = std::invoke_result_t<std::decay_t<F>&>; // Результат задания F
+
+    class ThreadPool
+    {
+        std::mutex mtx;
+        std::condition_variable not_empty, not_full;
+        std::vector<std::function<void()>> jobs; // Кольцо на capacity заданий
+        std::size_t first, count; // Начало очереди в кольце и её длина
+        std::vector<std::thread> threads;
+        std::size_t capacity;
+        bool stopping;
+
+    public:
+
+        ThreadPool() : first(0), count(0), capacity(1), stopping(false) {}
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator= (const ThreadPool&) = delete;
+        ~ThreadPool() { stop(); }
+
+        // Запуск workers потоков (0 - по числу аппаратных) с очередью не более чем
+        // на _capacity заданий
+        void start(std::size_t workers, std::size_t _capacity)
+        {
+            capacity = std::max<std::size_t>(1, _capacity);
+            jobs.assign(capacity, nullptr);
+            first = count = 0;
+            stopping = false;
+            if (workers == 0)
+                workers = std::max(1u, std::thread::hardware_concurrency());
+            for (std::size_t i = 0; i < workers; ++i)
+                threads.emplace_back(&ThreadPool::body, this, i);
+        }
+
+        // Остановка после выполнения уже поставленных заданий
+        void stop()
+        {
+            {
+                std::lock_guard<std::mutex> lck(mtx);
+                stopping = true;
+            }
+            not_empty.notify_all();
+            not_full.notify_all();
+            for (auto& t : threads)
+                t.join();
+            threads.clear();
+        }
+
+        // Постановка задания. Если очередь полна, ждёт места; поток самого пула
+        // в этом случае выполняет задание сразу, чтобы не ждать самого себя.
+        // Без запущенных потоков задание также выполняется сразу.
+        // Задание пула не должно ждать результатов заданий, поставленных им же:
+        // при занятых потоках их некому будет выполнить
+        template <typename F>
+        std::future<JobResult<F>> submit(F&& f)
+        {
+            auto task = std::make_shared<std::packaged_task<JobResult<F>()>>(std::forward<F>(f));
+            auto result = task->get_future();
+            post([task] { (*task)(); });
+            return result;
+        }
+
+        // Постановка задания без результата, на тех же условиях
+        template <typename F>
+        void post(F&& f)
+        {
+            {
+                std::unique_lock<std::mutex> lck(mtx);
+                if (threads.empty() || stopping || (count >= capacity && current() == this))
+                {
+                    lck.unlock();
+                    f();
+                    return;
+                }
+                not_full.wait(lck, [this] { return count < capacity || stopping; });
+                jobs[(first + count++) % capacity] = std::forward<F>(f);
+            }
+            not_empty.notify_one();
+        }
+
+        std::size_t threads_get() const { return threads.size(); }
+
+        // Номер вызывающего потока в пуле; для прочих потоков - threads_get()
+        std::size_t worker_index() const
+        {
+            return current() == this ? index() : threads.size();
+        }
+
+    private:
+
+        // Пул, которому принадлежит вызывающий поток
+        static ThreadPool*& current()
+        {
+            thread_local ThreadPool *pool = nullptr;
+            return pool;
+        }
+
+        static std::size_t& index()
+        {
+            thread_local std::size_t i = 0;
+            return i;
+        }
+
+        void body(std::size_t i)
+        {
+            current() = this;
+            index() = i;
+            while (true)
+            {
+                std::function<void()> job;
+                {
+                    std::unique_lock<std::mutex> lck(mtx);
+                    not_empty.wait(lck, [this] { return count > 0 || stopping; });
+                    if (count == 0)
+                        return;
+                    job.swap(jobs[first]); // Ячейка кольца остаётся пустой
+                    first = (first + 1) % capacity;
+                    --count;
+                }
+                not_full.notify_one();
+                job();
+            }
+        }
+    };
+
+    class InlineExecutor
+    {
+    public:
+
+        void start(std::size_t, std::size_t) {}
+        void stop() {}
+
+        template <typename F>
+        std::future<JobResult<F>> submit(F&& f)
+        {
+            std::packaged_task<JobResult<F>()> task(std::forward<F>(f));
+            auto result = task.get_future();
+            task();
+            return result;
+        }
+
+        template <typename F>
+        void post(F&& f) { f(); }
+
+        std::size_t threads_get() const { return 0; }
+        std::size_t worker_index() const { return 0; }
+    };
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright(c) 2017 https://github.com/mrprint
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
@@ -0,0 +1,227 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include <utility>
+#include "gridpolicies.hpp"
+
+// Поле потока к одной цели
+// Хранит для каждой клетки стоимость достижения цели (поле интеграции) и
+// направление первого шага, поэтому любое число агентов узнаёт следующий шаг
+// за O(1) без собственного поиска. Поле строится волной Дейкстры по корзинам
+// (стоимости шагов - малые целые), а при смене проходимости клетки пересчитываются
+// лишь зависящие от неё клетки.
+// Модель передвижения та же, что и у AStar: вход в клетку-препятствие запрещен,
+// срезание углов допускается, шаг по прямой стоит 10, по диагонали - 19.
+template<
+    size_t H, size_t W, // Размерность карты
+    typename TCoords, // Тип координат, предоставляющий члены "x" и "y". Со знаком
+    typename TMap // Карта. Предоставляет "isobstacle(x, y)"
+>
+class FlowField
+{
+    using TWeight = int;
+
+    static constexpr TWeight INF = std::numeric_limits<TWeight>::max() / 4;
+    static constexpr TWeight STEP_COST = tool::GRID_STEP_COST;
+    static constexpr TWeight DIAG_COST = tool::GRID_DIAG_COST;
+    static constexpr unsigned char NO_DIR = 8;
+    static constexpr size_t RING = 32; // Корзин в кольце, больше наибольшей стоимости шага
+
+    static constexpr struct { int x, y; TWeight d; } dirs[] =
+    { { -1, -1, DIAG_COST },{ 0, -1, STEP_COST },{ 1, -1, DIAG_COST },{ -1, 0, STEP_COST },
+      { 1, 0, STEP_COST },{ -1, 1, DIAG_COST },{ 0, 1, STEP_COST },{ 1, 1, DIAG_COST } };
+
+    using Item = std::pair<TWeight, unsigned>; // Оценка и клетка
+
+    std::unique_ptr<TWeight[]> dist; // Поле интеграции
+    std::unique_ptr<unsigned char[]> dir; // Поле направлений: индекс в dirs
+    std::vector<Item> buckets[RING];
+    std::vector<Item> seeds;
+    std::vector<unsigned> stack;
+    TCoords goal_p;
+    bool built;
+
+public:
+
+    FlowField() : dist(new TWeight[H * W]), dir(new unsigned char[H * W]), built(false) {}
+
+    // Полное построение поля к указанной цели
+    void build(const TMap& map, const TCoords& _goal_p)
+    {
+        goal_p = _goal_p;
+        std::fill(dist.get(), dist.get() + H * W, INF);
+        std::fill(dir.get(), dir.get() + H * W, NO_DIR);
+        auto gi = index2d(goal_p.x, goal_p.y);
+        dist[gi] = 0;
+        seeds.clear();
+        seeds.emplace_back(0, gi);
+        propagate(map);
+        built = true;
+    }
+
+    // Уведомление о смене проходимости клетки; карта уже изменена
+    void cell_changed(const TMap& map, int x, int y)
+    {
+        if (!built || !inbound(x, y))
+            return;
+        if (x == goal_p.x && y == goal_p.y)
+        {
+            build(map, goal_p);
+            return;
+        }
+        auto ci = index2d(x, y);
+        seeds.clear();
+        if (map.isobstacle(x, y))
+        {
+            // Клетки, путь которых шёл через ставшую препятствием, теряют оценку
+            // и заново получают её от уцелевших соседей
+            stack.clear();
+            children_collect(ci);
+            for (size_t i = 0; i < stack.size(); ++i)
+                children_collect(stack[i]);
+            for (auto ui : stack)
+            {
+                int ux = static_cast<int>(ui % W), uy = static_cast<int>(ui / W);
+                for (unsigned char k = 0; k < 8; ++k)
+                {
+                    int vx = ux + dirs[k].x, vy = uy + dirs[k].y;
+                    if (!inbound(vx, vy) || map.isobstacle(vx, vy))
+                        continue;
+                    TWeight d = dist[index2d(vx, vy)];
+                    if (d < INF && d + dirs[k].d < dist[ui])
+                    {
+                        dist[ui] = d + dirs[k].d;
+                        dir[ui] = k;
+                    }
+                }
+                if (dist[ui] < INF)
+                    seeds.emplace_back(dist[ui], ui);
+            }
+            std::sort(seeds.begin(), seeds.end());
+        } else if (dist[ci] < INF)
+        {
+            // Освободившаяся клетка может сократить путь соседям
+            seeds.emplace_back(dist[ci], ci);
+        }
+        propagate(map);
+    }
+
+    // Смещение первого шага к цели. false - цель недостижима или уже достигнута
+    bool step_get(int x, int y, TCoords& ofs) const
+    {
+        auto k = dir[index2d(x, y)];
+        if (k == NO_DIR)
+            return false;
+        ofs.x = dirs[k].x;
+        ofs.y = dirs[k].y;
+        return true;
+    }
+
+    // Стоимость пути до цели; наибольшее значение TWeight для недостижимых клеток
+    TWeight distance_get(int x, int y) const
+    {
+        TWeight d = dist[index2d(x, y)];
+        return d < INF ? d : std::numeric_limits<TWeight>::max();
+    }
+
+    const TCoords& goal_get() const { return goal_p; }
+
+private:
+
+    // Волна от затравок (упорядочены по оценке) к предшественникам
+    void propagate(const TMap& map)
+    {
+        if (seeds.empty())
+            return;
+        size_t si = 0, queued = 0;
+        TWeight cur = seeds.front().first;
+        while (si < seeds.size() || queued > 0)
+        {
+            if (queued == 0 && seeds[si].first > cur)
+                cur = seeds[si].first;
+            for (; si < seeds.size() && seeds[si].first == cur; ++si, ++queued)
+                buckets[cur % RING].push_back(seeds[si]);
+            auto& bucket = buckets[cur % RING];
+            while (!bucket.empty())
+            {
+                Item it = bucket.back();
+                bucket.pop_back();
+                --queued;
+                if (it.first != dist[it.second])
+                    continue; // Устаревшая запись
+                int vx = static_cast<int>(it.second % W), vy = static_cast<int>(it.second / W);
+                if (map.isobstacle(vx, vy))
+                    continue; // В препятствие входить нельзя - через него путей нет
+                for (unsigned char k = 0; k < 8; ++k)
+                {
+                    int ux = vx - dirs[k].x, uy = vy - dirs[k].y;
+                    if (!inbound(ux, uy))
+                        continue;
+                    auto ui = index2d(ux, uy);
+                    TWeight d = it.first + dirs[k].d;
+                    if (d < dist[ui])
+                    {
+                        dist[ui] = d;
+                        dir[ui] = k;
+                        buckets[d % RING].emplace_back(d, ui);
+                        ++queued;
+                    }
+                }
+            }
+            ++cur;
+        }
+    }
+
+    // Добавляет в стек клетки, чей первый шаг ведёт в vi, и сбрасывает их оценки
+    void children_collect(unsigned vi)
+    {
+        int vx = static_cast<int>(vi % W), vy = static_cast<int>(vi / W);
+        for (unsigned char k = 0; k < 8; ++k)
+        {
+            int ux = vx - dirs[k].x, uy = vy - dirs[k].y;
+            if (!inbound(ux, uy))
+                continue;
+            auto ui = index2d(ux, uy);
+            if (dir[ui] != k)
+                continue;
+            dist[ui] = INF;
+            dir[ui] = NO_DIR;
+            stack.push_back(ui);
+        }
+    }
+
+    static unsigned index2d(int x, int y)
+    {
+        return static_cast<unsigned>(y * W + x);
+    }
+
+    static bool inbound(int x, int y)
+    {
+        return x >= 0 && x < static_cast<int>(W) && y >= 0 && y < static_cast<int>(H);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright(c) 2017 https://github.com/mrprint
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
@@ -0,0 +1,228 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <cmath>
+#include <type_traits>
+#include <utility>
+#include "bitboard.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Политики поиска пути по сетке: стоимости шагов, оценки расстояния,
+// связность и размещение узлов в памяти. Подставляются в AStar параметрами шаблона.
+////////////////////////////////////////////////////////////////////////////////
+
+namespace tool
+{
+
+    constexpr int GRID_STEP_COST = 10; // Шаг по прямой
+    constexpr int GRID_DIAG_COST = 19; // Шаг по диагонали
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Оценки расстояния
+
+    // Квадрат евклидова расстояния. Переоценивает, поиск ведёт себя жадно
+    struct HeuristicSquared
+    {
+        template <typename TCoords>
+        int operator()(const TCoords& a, const TCoords& b) const
+        {
+            int dx = b.x - a.x, dy = b.y - a.y;
+            return GRID_STEP_COST * (dx * dx + dy * dy);
+        }
+    };
+
+    // Октильное расстояние. Точно на пустом поле при 8-связности
+    struct HeuristicOctile
+    {
+        template <typename TCoords>
+        int operator()(const TCoords& a, const TCoords& b) const
+        {
+            int dx = std::abs(b.x - a.x), dy = std::abs(b.y - a.y);
+            return dx < dy
+                ? GRID_DIAG_COST * dx + GRID_STEP_COST * (dy - dx)
+                : GRID_DIAG_COST * dy + GRID_STEP_COST * (dx - dy);
+        }
+    };
+
+    // Расстояние Чебышёва в шагах по прямой
+    struct HeuristicChebyshev
+    {
+        template <typename TCoords>
+        int operator()(const TCoords& a, const TCoords& b) const
+        {
+            int dx = std::abs(b.x - a.x), dy = std::abs(b.y - a.y);
+            return GRID_STEP_COST * (dx < dy ? dy : dx);
+        }
+    };
+
+    // Евклидово расстояние в шагах по прямой
+    struct HeuristicEuclidean
+    {
+        template <typename TCoords>
+        int operator()(const TCoords& a, const TCoords& b) const
+        {
+            double dx = b.x - a.x, dy = b.y - a.y;
+            return static_cast<int>(GRID_STEP_COST * std::sqrt(dx * dx + dy * dy));
+        }
+    };
+
+    // Манхэттенское расстояние. Допустимо только при 4-связности
+    struct HeuristicManhattan
+    {
+        template <typename TCoords>
+        int operator()(const TCoords& a, const TCoords& b) const
+        {
+            return GRID_STEP_COST * (std::abs(b.x - a.x) + std::abs(b.y - a.y));
+        }
+    };
+
+    // Нулевая оценка - поиск вырождается в алгоритм Дейкстры
+    struct HeuristicZero
+    {
+        template <typename TCoords>
+        int operator()(const TCoords&, const TCoords&) const { return 0; }
+    };
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Связность
+    // expand() перебирает проходимых соседей клетки (x, y) поля w x h,
+    // вызывая visit(dx, dy, стоимость шага). Перебор развёрнут вручную
+    // и опирается на маску занятости окрестности (см. NeighbourBit).
+
+    template <typename TMap, typename = void>
+    struct HasObstaclesAround : std::false_type {};
+
+    template <typename TMap>
+    struct HasObstaclesAround<TMap, std::void_t<decltype(std::declval<const TMap&>().obstacles_around(0, 0))>>
+        : std::true_type {};
+
+    // Маска занятости окрестности 3x3. Клетки за пределами поля считаются занятыми.
+    // Если карта умеет выдавать её сама (obstacles_around), берётся готовая
+    template <typename TMap>
+    unsigned obstacles_around(const TMap& map, int x, int y, int w, int h)
+    {
+        if constexpr (HasObstaclesAround<TMap>::value)
+        {
+            return map.obstacles_around(x, y);
+        } else
+        {
+            const bool n = y > 0, s = y + 1 < h, wb = x > 0, e = x + 1 < w;
+            unsigned m = 0;
+            if (!(n && wb) || map.isobstacle(x - 1, y - 1)) m |= nbNW;
+            if (!n || map.isobstacle(x, y - 1)) m |= nbN;
+            if (!(n && e) || map.isobstacle(x + 1, y - 1)) m |= nbNE;
+            if (!wb || map.isobstacle(x - 1, y)) m |= nbW;
+            if (!e || map.isobstacle(x + 1, y)) m |= nbE;
+            if (!(s && wb) || map.isobstacle(x - 1, y + 1)) m |= nbSW;
+            if (!s || map.isobstacle(x, y + 1)) m |= nbS;
+            if (!(s && e) || map.isobstacle(x + 1, y + 1)) m |= nbSE;
+            return m;
+        }
+    }
+
+    // 4-связность
+    struct NeighbourhoodFour
+    {
+        template <typename TMap, typename F>
+        static void expand(const TMap& map, int x, int y, int w, int h, F&& visit)
+        {
+            const unsigned m = obstacles_around(map, x, y, w, h);
+            if (!(m & nbN)) visit(0, -1, GRID_STEP_COST);
+            if (!(m & nbW)) visit(-1, 0, GRID_STEP_COST);
+            if (!(m & nbE)) visit(1, 0, GRID_STEP_COST);
+            if (!(m & nbS)) visit(0, 1, GRID_STEP_COST);
+        }
+    };
+
+    // 8-связность со срезанием углов: диагональный шаг не зависит от соседних клеток
+    struct NeighbourhoodEight
+    {
+        template <typename TMap, typename F>
+        static void expand(const TMap& map, int x, int y, int w, int h, F&& visit)
+        {
+            const unsigned m = obstacles_around(map, x, y, w, h);
+            if (!(m & nbNW)) visit(-1, -1, GRID_DIAG_COST);
+            if (!(m & nbN)) visit(0, -1, GRID_STEP_COST);
+            if (!(m & nbNE)) visit(1, -1, GRID_DIAG_COST);
+            if (!(m & nbW)) visit(-1, 0, GRID_STEP_COST);
+            if (!(m & nbE)) visit(1, 0, GRID_STEP_COST);
+            if (!(m & nbSW)) visit(-1, 1, GRID_DIAG_COST);
+            if (!(m & nbS)) visit(0, 1, GRID_STEP_COST);
+            if (!(m & nbSE)) visit(1, 1, GRID_DIAG_COST);
+        }
+    };
+
+    // 8-связность без протискивания: диагональ запрещена, если заняты обе прилегающие клетки
+    struct NeighbourhoodEightNoSqueeze
+    {
+        template <typename TMap, typename F>
+        static void expand(const TMap& map, int x, int y, int w, int h, F&& visit)
+        {
+            const unsigned m = obstacles_around(map, x, y, w, h);
+            if (!(m & nbNW) && (m & (nbN | nbW)) != (nbN | nbW)) visit(-1, -1, GRID_DIAG_COST);
+            if (!(m & nbN)) visit(0, -1, GRID_STEP_COST);
+            if (!(m & nbNE) && (m & (nbN | nbE)) != (nbN | nbE)) visit(1, -1, GRID_DIAG_COST);
+            if (!(m & nbW)) visit(-1, 0, GRID_STEP_COST);
+            if (!(m & nbE)) visit(1, 0, GRID_STEP_COST);
+            if (!(m & nbSW) && (m & (nbS | nbW)) != (nbS | nbW)) visit(-1, 1, GRID_DIAG_COST);
+            if (!(m & nbS)) visit(0, 1, GRID_STEP_COST);
+            if (!(m & nbSE) && (m & (nbS | nbE)) != (nbS | nbE)) visit(1, 1, GRID_DIAG_COST);
+        }
+    };
+
+    // 8-связность без срезания углов: диагональ разрешена, только если свободны обе прилегающие клетки
+    struct NeighbourhoodEightNoCut
+    {
+        template <typename TMap, typename F>
+        static void expand(const TMap& map, int x, int y, int w, int h, F&& visit)
+        {
+            const unsigned m = obstacles_around(map, x, y, w, h);
+            if (!(m & (nbNW | nbN | nbW))) visit(-1, -1, GRID_DIAG_COST);
+            if (!(m & nbN)) visit(0, -1, GRID_STEP_COST);
+            if (!(m & (nbNE | nbN | nbE))) visit(1, -1, GRID_DIAG_COST);
+            if (!(m & nbW)) visit(-1, 0, GRID_STEP_COST);
+            if (!(m & nbE)) visit(1, 0, GRID_STEP_COST);
+            if (!(m & (nbSW | nbS | nbW))) visit(-1, 1, GRID_DIAG_COST);
+            if (!(m & nbS)) visit(0, 1, GRID_STEP_COST);
+            if (!(m & (nbSE | nbS | nbE))) visit(1, 1, GRID_DIAG_COST);
+        }
+    };
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Размещение узлов в памяти
+    // index<H, W>(x, y) отображает клетку поля H x W в индекс массива узлов,
+    // size<H, W>() - нужная длина массива (с учётом выравнивания, если оно есть).
+
+    // Построчно
+    struct LayoutRowMajor
+    {
+        template <std::size_t H, std::size_t W>
+        static constexpr std::size_t size() { return H * W; }
+
+        template <std::size_t H, std::size_t W>
+        static std::size_t index(std::size_t x, std::size_t y) { return y * W + x; }
+    };
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright(c) 2017 https://github.com/mrprint
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
@@ -0,0 +1,482 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <memory>
+#include <limits>
+#include <algorithm>
+#include <functional>
+#include "gridpolicies.hpp"
+#include "spscring.hpp"
+
+// Параллельный A* с распределением клеток по хэшу (HDA*, Hash Distributed A*)
+// Каждая клетка принадлежит одному потоку: только он хранит её в своём открытом
+// списке и меняет её стоимость, поэтому общие массивы атрибутов не требуют
+// блокировок. Сосед чужой клетки пересылается владельцу через кольцо SpscRing;
+// у каждой упорядоченной пары потоков кольцо своё. Владелец назначается по хэшу
+// блока BLOCK x BLOCK: соседи внутри блока обходятся без пересылок, а хэш
+// выравнивает нагрузку. Стоимость лучшего найденного пути общая, узлы с оценкой
+// не лучше неё отсекаются.
+// Поиск завершён, когда нет ни активных потоков, ни пересланных и ещё не
+// принятых узлов. Оба числа ведутся одним счётчиком: пересылка увеличивает его
+// до отправки, приём уменьшает после обработки, а бездействующий поток,
+// принявший узел, становится активным без изменения счётчика. Поэтому ноль
+// в нём - устойчивое состояние, и проверка не требует дополнительных раундов.
+// Поток не раскрывает узлы, оценка которых больше наименьшей из оценок вершин
+// чужих открытых списков (с учётом пересылаемых узлов) более чем на SLACK:
+// иначе поток, опередивший остальных (например, пока они вытеснены с ядра),
+// раскрывает узлы по неточным стоимостям, и исправления расходятся волной
+// повторных раскрытий. Параллельно раскрываются узлы с равными оценками.
+// Путь оптимален при допустимой оценке. Поток-инициатор поиска работает как
+// поток 0; остальные создаются при первом поиске и спят между поисками, так
+// что запрос не платит за их запуск. Синхронизация на каждом поиске всё же
+// заметна, поэтому он оправдан лишь для длинных путей на больших полях.
+template<
+    size_t H, size_t W, // Размерность карты
+    typename TCoords, // Тип координат, предоставляющий члены "x" и "y". Со знаком
+    typename TMap, // Карта. Предоставляет "isobstacle(x, y)". Читается всеми потоками одновременно
+    typename TWeight = int, // Тип веса
+    typename TPath = std::vector<TCoords>, // Возвращаемый путь, предоставляющий push_back
+    typename THeuristic = tool::HeuristicOctile, // Оценка расстояния (см. gridpolicies.hpp)
+    typename TNeighbourhood = tool::NeighbourhoodEight // Связность (см. gridpolicies.hpp)
+>
+class HDAStar
+{
+    static constexpr size_t BLOCK = 4; // Сторона блока клеток одного владельца
+    static constexpr size_t RING = 1024; // Ёмкость кольца между парой потоков
+    static constexpr size_t BATCH = 16; // Раскрытий между проверками входящих
+    static constexpr TWeight SLACK = 0; // Допустимое опережение других потоков
+    static constexpr TWeight INF = std::numeric_limits<TWeight>::max();
+
+    struct Message // Узел, пересылаемый владельцу
+    {
+        unsigned cell;
+        TWeight gscore, fscore;
+        unsigned char link;
+    };
+
+    struct Entry // Запись открытого списка. Устаревшие записи не удаляются, а пропускаются
+    {
+        TWeight fscore, gscore;
+        unsigned cell;
+        // При равных оценках первой раскрывается более глубокая
+        bool operator> (const Entry& r) const { return fscore > r.fscore || (fscore == r.fscore && gscore < r.gscore); }
+    };
+
+    struct Worker // Собственность одного потока
+    {
+        alignas(64) std::atomic<TWeight> frontier; // Оценка вершины открытого списка; читают все
+        std::vector<Entry> opened;
+        std::vector<std::vector<Message>> outbox; // Не отправленное, по адресатам
+        size_t staged; // Узлы в outbox, ещё не учтённые в счётчике work
+        size_t expansions;
+    };
+
+    using Ring = tool::SpscRing<Message, RING>;
+
+    struct Workspace
+    {
+        std::unique_ptr<TWeight[]> gscores; // Пишет только владелец клетки
+        std::unique_ptr<unsigned char[]> links; // Направление на предыдущую клетку (см. link_make)
+        std::unique_ptr<unsigned[]> epochs; // Поколение поиска, в котором заполнена клетка
+        std::vector<Worker> workers;
+        std::vector<std::unique_ptr<Ring>> rings; // Кольцо от i к j - под номером i * P + j
+        unsigned epoch;
+        alignas(64) std::atomic<TWeight> best; // Стоимость лучшего найденного пути до цели
+        alignas(64) std::atomic<long> work; // Активные потоки и пересылаемые узлы
+
+        explicit Workspace(unsigned P) :
+            gscores(new TWeight[H * W]), links(new unsigned char[H * W]), epochs(new unsigned[H * W]()),
+            workers(P), epoch(0), best(INF), work(0)
+        {
+            for (auto& wk : workers)
+                wk.outbox.resize(P);
+            rings.resize(P * P);
+            for (unsigned i = 0; i < P; ++i)
+                for (unsigned j = 0; j < P; ++j)
+                    if (i != j)
+                        rings[i * P + j].reset(new Ring);
+        }
+
+        void renew()
+        {
+            if (++epoch == 0)
+            {
+                std::fill(epochs.get(), epochs.get() + H * W, 0u);
+                epoch = 1;
+            }
+            for (auto& wk : workers)
+            {
+                wk.frontier.store(INF);
+                wk.opened.clear();
+                wk.staged = 0;
+                wk.expansions = 0;
+            }
+            best.store(INF);
+            work.store(static_cast<long>(workers.size())); // Все потоки стартуют активными
+        }
+    };
+
+    // Потоки 1..threads-1, живущие от первого поиска до разрушения планировщика
+    struct Crew
+    {
+        std::mutex mtx;
+        std::condition_variable wake, done;
+        std::vector<std::thread> helpers;
+        unsigned long round; // Номер поиска; помощники просыпаются на новый
+        unsigned busy; // Помощники, не закончившие текущий поиск
+        bool stopping;
+        // Задание текущего поиска
+        Workspace *w;
+        const TMap *map;
+        TCoords finish_p;
+        const std::atomic<bool> *cancel;
+
+        Crew() : round(0), busy(0), stopping(false), w(nullptr), map(nullptr), cancel(nullptr) {}
+    };
+
+    THeuristic heuristic;
+    unsigned threads;
+    std::unique_ptr<Workspace> ws; // Создаётся по требованию
+    std::unique_ptr<Crew> crew; // Создаётся при первом поиске
+
+public:
+
+    // Число потоков; 0 - по числу аппаратных
+    explicit HDAStar(unsigned _threads = 0, const THeuristic& _heuristic = THeuristic()) :
+        heuristic(_heuristic), threads(_threads ? _threads : std::max(1u, std::thread::hardware_concurrency())) {}
+    HDAStar(const HDAStar&) = delete;
+    HDAStar& operator= (const HDAStar&) = delete;
+
+    ~HDAStar()
+    {
+        if (!crew)
+            return;
+        {
+            std::lock_guard<std::mutex> lck(crew->mtx);
+            crew->stopping = true;
+        }
+        crew->wake.notify_all();
+        for (auto& h : crew->helpers)
+            h.join();
+    }
+
+    unsigned threads_get() const { return threads; }
+
+    size_t expansions_get() const
+    {
+        size_t n = 0;
+        if (ws)
+            for (auto& wk : ws->workers)
+                n += wk.expansions;
+        return n;
+    }
+
+    // Получить смещения (в обратном порядке). Карта во время поиска меняться не должна.
+    // Флаг отмены проверяется каждым потоком перед очередной порцией раскрытий
+    bool search_ofs(TPath& path, const TMap& map, const TCoords& start_p, const TCoords& finish_p,
+        const std::atomic<bool> *cancel = nullptr)
+    {
+        if (!ws)
+            ws.reset(new Workspace(threads));
+        Workspace& w = *ws;
+        w.renew();
+        const unsigned goal = index2d(finish_p.x, finish_p.y);
+        const Message start{ index2d(start_p.x, start_p.y), 0, cost_estimate(start_p, finish_p), 0 };
+        relax(w, w.workers[owner(start_p.x, start_p.y)], start, goal);
+        if (threads > 1)
+        {
+            if (!crew)
+            {
+                crew.reset(new Crew);
+                for (unsigned t = 1; t < threads; ++t)
+                    crew->helpers.emplace_back(&HDAStar::helper_body, this, t);
+            }
+            {
+                std::lock_guard<std::mutex> lck(crew->mtx);
+                crew->w = &w;
+                crew->map = &map;
+                crew->finish_p = finish_p;
+                crew->cancel = cancel;
+                crew->busy = threads - 1;
+                ++crew->round;
+            }
+            crew->wake.notify_all();
+        }
+        worker_body(w, map, 0, finish_p, cancel);
+        if (threads > 1)
+        {
+            std::unique_lock<std::mutex> lck(crew->mtx);
+            crew->done.wait(lck, [this] { return crew->busy == 0; });
+        }
+        if (w.best.load() == INF || (cancel && cancel->load()))
+            return false;
+        get_path_ofs(w, path, start_p, finish_p);
+        return true;
+    }
+
+private:
+
+    void helper_body(unsigned self)
+    {
+        Crew& c = *crew;
+        unsigned long seen = 0;
+        while (true)
+        {
+            Workspace *w;
+            const TMap *map;
+            TCoords finish_p;
+            const std::atomic<bool> *cancel;
+            {
+                std::unique_lock<std::mutex> lck(c.mtx);
+                c.wake.wait(lck, [&c, seen] { return c.stopping || c.round != seen; });
+                if (c.stopping)
+                    return;
+                seen = c.round;
+                w = c.w;
+                map = c.map;
+                finish_p = c.finish_p;
+                cancel = c.cancel;
+            }
+            worker_body(*w, *map, self, finish_p, cancel);
+            std::lock_guard<std::mutex> lck(c.mtx);
+            if (--c.busy == 0)
+                c.done.notify_one();
+        }
+    }
+
+    void worker_body(Workspace& w, const TMap& map, unsigned self, TCoords finish_p, const std::atomic<bool> *cancel) const
+    {
+        Worker& me = w.workers[self];
+        const unsigned goal = index2d(finish_p.x, finish_p.y);
+        bool active = true;
+        while (true)
+        {
+            // Приём. Первый узел, принятый бездействующим потоком, остаётся
+            // в счётчике уже как активный поток
+            long consumed = 0;
+            for (unsigned from = 0; from < threads; ++from)
+            {
+                if (from == self)
+                    continue;
+                Ring& ring = *w.rings[from * threads + self];
+                Message m;
+                while (ring.try_pop(m))
+                {
+                    if (active)
+                        ++consumed;
+                    else
+                        active = true;
+                    relax(w, me, m, goal);
+                }
+            }
+            // Отменённый поиск лишь дочищает кольца, чтобы счётчик work сошёлся к нулю
+            if (cancel && cancel->load(std::memory_order_relaxed))
+                me.opened.clear();
+            // Раскрытие, не забегая вперёд других потоков
+            const TWeight bound = bound_get(w, self);
+            bool expanded = false;
+            for (size_t n = 0; n < BATCH && !me.opened.empty(); ++n)
+            {
+                Entry e = me.opened.front();
+                if (e.fscore > bound)
+                    break;
+                std::pop_heap(me.opened.begin(), me.opened.end(), std::greater<Entry>());
+                me.opened.pop_back();
+                if (e.gscore > w.gscores[e.cell])
+                    continue; // Устаревшая запись
+                if (e.fscore >= w.best.load(std::memory_order_relaxed))
+                {
+                    me.opened.clear(); // Остальные записи не лучше
+                    break;
+                }
+                expand(w, me, map, self, e, finish_p, goal);
+                expanded = true;
+            }
+            // Новые пересылки учитываются до отправки, принятые - после обработки
+            if (me.staged > 0)
+            {
+                w.work.fetch_add(static_cast<long>(me.staged));
+                me.staged = 0;
+            }
+            TWeight front = outbox_flush(w, me, self);
+            if (!me.opened.empty())
+                front = std::min(front, me.opened.front().fscore);
+            me.frontier.store(front, std::memory_order_relaxed);
+            if (consumed > 0)
+                w.work.fetch_sub(consumed);
+            if (expanded)
+                continue;
+            if (me.opened.empty())
+            {
+                if (active)
+                {
+                    active = false;
+                    w.work.fetch_sub(1);
+                }
+                if (w.work.load() == 0)
+                    break;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    void expand(Workspace& w, Worker& me, const TMap& map, unsigned self, const Entry& e, const TCoords& finish_p, unsigned goal) const
+    {
+        ++me.expansions;
+        const int x = static_cast<int>(e.cell % W), y = static_cast<int>(e.cell / W);
+        const TWeight best = w.best.load(std::memory_order_relaxed);
+        TNeighbourhood::expand(map, x, y, static_cast<int>(W), static_cast<int>(H), [&](int dx, int dy, int d)
+        {
+            TCoords np;
+            np.x = x + dx;
+            np.y = y + dy;
+            const Message m{ index2d(np.x, np.y), e.gscore + d, e.gscore + d + cost_estimate(np, finish_p), link_make(dx, dy) };
+            if (m.fscore >= best)
+                return; // Не лучше уже найденного пути
+            const unsigned o = owner(np.x, np.y);
+            if (o == self)
+            {
+                relax(w, me, m, goal);
+            } else
+            {
+                me.outbox[o].push_back(m);
+                ++me.staged;
+            }
+        });
+    }
+
+    // Узел пришёл в клетку своего потока
+    void relax(Workspace& w, Worker& me, const Message& m, unsigned goal) const
+    {
+        if (w.epochs[m.cell] != w.epoch)
+        {
+            w.epochs[m.cell] = w.epoch;
+            w.gscores[m.cell] = INF;
+        }
+        if (m.gscore >= w.gscores[m.cell])
+            return;
+        w.gscores[m.cell] = m.gscore;
+        w.links[m.cell] = m.link;
+        if (m.cell == goal)
+        {
+            // Цель не раскрывается: пути через неё к ней самой длиннее
+            TWeight b = w.best.load();
+            while (m.gscore < b && !w.best.compare_exchange_weak(b, m.gscore)) {}
+            return;
+        }
+        if (m.fscore >= w.best.load(std::memory_order_relaxed))
+            return;
+        me.opened.push_back(Entry{ m.fscore, m.gscore, m.cell });
+        std::push_heap(me.opened.begin(), me.opened.end(), std::greater<Entry>());
+    }
+
+    // Наибольшая оценка, которую потоку self разрешено раскрыть
+    TWeight bound_get(const Workspace& w, unsigned self) const
+    {
+        TWeight m = INF;
+        for (unsigned t = 0; t < threads; ++t)
+            if (t != self)
+                m = std::min(m, w.workers[t].frontier.load(std::memory_order_relaxed));
+        return m > INF - SLACK ? INF : m + SLACK;
+    }
+
+    // Отправка накопленного; не уместившееся в кольца ждёт следующего раза.
+    // Вершина открытого списка получателя ещё не учитывает отправленное, поэтому
+    // её оценка сразу снижается до наименьшей из отправленных; получатель
+    // заменит её своей, когда примет узлы. Возвращает наименьшую оценку
+    // оставшегося в outbox
+    TWeight outbox_flush(Workspace& w, Worker& me, unsigned self) const
+    {
+        TWeight left = INF;
+        for (unsigned to = 0; to < threads; ++to)
+        {
+            auto& out = me.outbox[to];
+            if (out.empty())
+                continue;
+            Ring& ring = *w.rings[self * threads + to];
+            size_t sent = 0;
+            TWeight low = INF;
+            for (; sent < out.size() && ring.try_push(out[sent]); ++sent)
+                low = std::min(low, out[sent].fscore);
+            if (sent > 0)
+            {
+                auto& frontier = w.workers[to].frontier;
+                TWeight f = frontier.load(std::memory_order_relaxed);
+                while (low < f && !frontier.compare_exchange_weak(f, low, std::memory_order_relaxed)) {}
+            }
+            out.erase(out.begin(), out.begin() + sent);
+            for (const auto& m : out)
+                left = std::min(left, m.fscore);
+        }
+        return left;
+    }
+
+    unsigned owner(int x, int y) const
+    {
+        constexpr size_t BW = (W + BLOCK - 1) / BLOCK;
+        unsigned b = static_cast<unsigned>(static_cast<size_t>(y) / BLOCK * BW + static_cast<size_t>(x) / BLOCK);
+        return ((b * 2654435761u) >> 16) % threads; // Мультипликативный хэш Кнута
+    }
+
+    TWeight cost_estimate(const TCoords& a, const TCoords& b) const
+    {
+        return static_cast<TWeight>(heuristic(a, b));
+    }
+
+    static void get_path_ofs(const Workspace& w, TPath& path, const TCoords& start_p, const TCoords& finish_p)
+    {
+        TCoords p = finish_p;
+        while (p.x != start_p.x || p.y != start_p.y)
+        {
+            TCoords ofs = link_ofs(w.links[index2d(p.x, p.y)]);
+            path.push_back(ofs);
+            p.x -= ofs.x;
+            p.y -= ofs.y;
+        }
+    }
+
+    static unsigned index2d(int x, int y)
+    {
+        return static_cast<unsigned>(y * W + x);
+    }
+
+    // Направление кодируется так же, как биты NeighbourBit: (dy + 1) * 3 + (dx + 1)
+    static unsigned char link_make(int dx, int dy)
+    {
+        return static_cast<unsigned char>((dy + 1) * 3 + (dx + 1));
+    }
+
+    static TCoords link_ofs(unsigned char l)
+    {
+        TCoords ofs;
+        ofs.x = l % 3 - 1;
+        ofs.y = l / 3 - 1;
+        return ofs;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright(c) 2017 https://github.com/mrprint
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
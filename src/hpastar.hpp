@@ -0,0 +1,572 @@
+﻿#pragma once
+
+#include <cstdlib>
+#include <limits>
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <utility>
+#include "openlist.hpp"
+#include "gridpolicies.hpp"
+
+// Иерархический поиск пути (HPA*)
+// Поле разбивается на кластеры CxC. На границах кластеров выделяются входы,
+// образующие абстрактный граф: рёбра между кластерами - единичные шаги,
+// внутри кластера - предрассчитанные кратчайшие расстояния между его входами.
+// Поиск идёт сначала по абстрактному графу, затем найденные отрезки
+// уточняются локальным поиском внутри своих кластеров.
+// Изменение клетки перестраивает только границы и рёбра затронутых кластеров.
+// Модель передвижения та же, что и у AStar: срезание углов допускается,
+// шаг по прямой стоит 10, по диагонали - 19. Результат близок к оптимальному.
+template<
+    size_t H, size_t W, // Размерность карты
+    typename TCoords, // Тип координат, предоставляющий члены "x" и "y". Со знаком
+    typename TMap, // Карта. Предоставляет "isobstacle(x, y)"
+    size_t C = 16, // Размер стороны кластера
+    typename TPath = std::vector<TCoords> // Возвращаемый путь, предоставляющий push_back
+>
+class HPAStar
+{
+    using TWeight = int;
+
+    static_assert(C >= 2 && C * C < 0xFFFF, "Unsupported cluster size");
+
+    static constexpr TWeight INF = std::numeric_limits<TWeight>::max() / 4;
+    static constexpr TWeight STEP_COST = tool::GRID_STEP_COST;
+    static constexpr TWeight DIAG_COST = tool::GRID_DIAG_COST;
+    static constexpr size_t CX = (W + C - 1) / C; // Кластеров по горизонтали
+    static constexpr size_t CY = (H + C - 1) / C; // Кластеров по вертикали
+    static constexpr size_t MAXE = 4 * C; // Входы лежат только на краях кластера
+    static constexpr unsigned short NO_SLOT = 0xFFFF;
+    static constexpr unsigned NONE = std::numeric_limits<unsigned>::max();
+    static constexpr unsigned CANCEL_PERIOD = 16; // Узлов абстрактного графа между проверками флага отмены
+
+    using Transitions = std::vector<std::pair<unsigned, unsigned> >; // Пары смежных клеток соседних кластеров
+
+    struct Cluster
+    {
+        std::vector<unsigned> ents; // Клетки входов
+        std::vector<std::vector<std::pair<unsigned, TWeight> > > inter; // Переходы в соседние кластеры
+        std::vector<TWeight> dist; // Расстояния между входами, ents.size() x ents.size()
+    };
+
+    // Узел поиска (абстрактного либо локального)
+    struct Node
+    {
+        TWeight g, f;
+        unsigned parent;
+        unsigned heap_idx;
+        unsigned stamp;
+        bool closed;
+    };
+
+    struct NodePtr
+    {
+        Node *pn;
+        unsigned id;
+        NodePtr() noexcept { /* NO MEMBERS INIT */ };
+        NodePtr(Node *nodes, unsigned i) noexcept : pn(&nodes[i]), id(i) {}
+        bool operator> (const NodePtr& r) const { return r.pn->f < pn->f; }
+        bool operator== (const NodePtr& r) const { return pn == r.pn; }
+        unsigned& heap_pos() const { return pn->heap_idx; }
+    };
+
+    // Рабочее пространство поиска со сбросом по номеру поколения
+    struct Workspace
+    {
+        std::unique_ptr<Node[]> nodes;
+        tool::IndexedOpenList<NodePtr> opened;
+        unsigned stamp;
+        explicit Workspace(size_t n) : nodes(new Node[n]()), stamp(0) {}
+        void restart(size_t n)
+        {
+            if (++stamp == 0)
+            {
+                for (size_t i = 0; i < n; ++i) nodes[i].stamp = 0;
+                stamp = 1;
+            }
+            opened.clear();
+        }
+        Node& get(unsigned i)
+        {
+            Node& n = nodes[i];
+            if (n.stamp != stamp)
+            {
+                n.g = INF; n.f = INF; n.parent = NONE; n.closed = false; n.stamp = stamp;
+            }
+            return n;
+        }
+    };
+
+    static constexpr struct { int x, y; TWeight d; } dirs[] =
+    { { -1, -1, DIAG_COST },{ 0, -1, STEP_COST },{ 1, -1, DIAG_COST },{ -1, 0, STEP_COST },
+      { 1, 0, STEP_COST },{ -1, 1, DIAG_COST },{ 0, 1, STEP_COST },{ 1, 1, DIAG_COST } };
+
+    std::vector<Cluster> clusters;
+    Transitions trans_e[CY][CX]; // Между (cx, cy) и (cx + 1, cy)
+    Transitions trans_s[CY][CX]; // Между (cx, cy) и (cx, cy + 1)
+    Transitions trans_d[CY][CX]; // Угловые между (cx, cy) и (cx + 1, cy + 1)
+    Transitions trans_a[CY][CX]; // Угловые между (cx + 1, cy) и (cx, cy + 1)
+    std::unique_ptr<unsigned short[]> slot; // Номер входа в своём кластере
+    std::vector<unsigned> changed; // Клетки, изменившиеся после последнего поиска
+    bool built;
+
+    Workspace abstract; // Абстрактный граф: кластер * MAXE + вход, затем старт и цель
+    Workspace local; // Поиск внутри кластера, индексы клеток относительно кластера
+    std::vector<TWeight> start_costs, finish_costs;
+
+public:
+
+    HPAStar() :
+        clusters(CX * CY),
+        slot(new unsigned short[H * W]),
+        built(false),
+        abstract(CX * CY * MAXE + 2),
+        local(C * C)
+    {}
+
+    // Уведомление о смене проходимости клетки
+    void cell_changed(int x, int y)
+    {
+        if (built && inbound(x, y))
+            changed.push_back(index2d(x, y));
+    }
+
+    // Сброс абстрактного графа: будет полностью перестроен при следующем поиске
+    void reset()
+    {
+        built = false;
+        changed.clear();
+    }
+
+    // Получить смещения (в обратном порядке). Поиск, прерванный флагом отмены,
+    // возвращает false; граф при этом уже приведён к текущей карте
+    bool search_ofs(TPath& path, const TMap& map, const TCoords& start_p, const TCoords& finish_p,
+        const std::atomic<bool> *cancel = nullptr)
+    {
+        if (!built)
+            build(map);
+        else
+            changes_apply(map);
+        if (map.isobstacle(finish_p.x, finish_p.y))
+            return false;
+        std::vector<unsigned> waypoints;
+        if (!abstract_search(map, start_p, finish_p, waypoints, cancel))
+            return false;
+        std::vector<unsigned> cells;
+        cells.push_back(waypoints.front());
+        for (size_t i = 1; i < waypoints.size(); ++i)
+        {
+            if (cancel && cancel->load(std::memory_order_relaxed))
+                return false;
+            refine(map, waypoints[i - 1], waypoints[i], cells);
+        }
+        for (size_t i = cells.size() - 1; i > 0; --i)
+        {
+            TCoords p;
+            p.x = static_cast<int>(cells[i] % W) - static_cast<int>(cells[i - 1] % W);
+            p.y = static_cast<int>(cells[i] / W) - static_cast<int>(cells[i - 1] / W);
+            path.push_back(p);
+        }
+        return true;
+    }
+
+private:
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Построение абстрактного графа
+
+    void build(const TMap& map)
+    {
+        for (size_t i = 0; i < H * W; ++i)
+            slot[i] = NO_SLOT;
+        for (size_t cy = 0; cy < CY; ++cy)
+            for (size_t cx = 0; cx < CX; ++cx)
+            {
+                if (cx + 1 < CX) border_e(map, cx, cy);
+                if (cy + 1 < CY) border_s(map, cx, cy);
+                if (cx + 1 < CX && cy + 1 < CY) corners(map, cx, cy);
+            }
+        for (size_t k = 0; k < CX * CY; ++k)
+            cluster_build(map, k);
+        changed.clear();
+        built = true;
+    }
+
+    void changes_apply(const TMap& map)
+    {
+        if (changed.empty())
+            return;
+        std::vector<size_t> dirty;
+        for (auto ci : changed)
+        {
+            size_t x = ci % W, y = ci / W;
+            size_t cx = x / C, cy = y / C, lx = x % C, ly = y % C;
+            dirty.push_back(cy * CX + cx);
+            if (lx == 0 && cx > 0)
+            {
+                border_e(map, cx - 1, cy); dirty.push_back(cy * CX + cx - 1);
+            }
+            if (lx == C - 1 && cx + 1 < CX)
+            {
+                border_e(map, cx, cy); dirty.push_back(cy * CX + cx + 1);
+            }
+            if (ly == 0 && cy > 0)
+            {
+                border_s(map, cx, cy - 1); dirty.push_back((cy - 1) * CX + cx);
+            }
+            if (ly == C - 1 && cy + 1 < CY)
+            {
+                border_s(map, cx, cy); dirty.push_back((cy + 1) * CX + cx);
+            }
+            if ((lx == 0 || lx == C - 1) && (ly == 0 || ly == C - 1))
+            {
+                // Угловая клетка: затрагивает все четыре кластера вокруг угла
+                size_t kx = lx == 0 ? cx - 1 : cx, ky = ly == 0 ? cy - 1 : cy;
+                if ((lx != 0 || cx > 0) && (ly != 0 || cy > 0) && kx + 1 < CX && ky + 1 < CY)
+                {
+                    corners(map, kx, ky);
+                    dirty.push_back(ky * CX + kx); dirty.push_back(ky * CX + kx + 1);
+                    dirty.push_back((ky + 1) * CX + kx); dirty.push_back((ky + 1) * CX + kx + 1);
+                }
+            }
+        }
+        changed.clear();
+        std::sort(dirty.begin(), dirty.end());
+        dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+        for (auto k : dirty)
+            cluster_build(map, k);
+    }
+
+    // Переходы через вертикальную границу между (cx, cy) и (cx + 1, cy)
+    void border_e(const TMap& map, size_t cx, size_t cy)
+    {
+        int ax = static_cast<int>(cx * C + C - 1);
+        int y0 = static_cast<int>(cy * C), len = static_cast<int>(std::min(C, H - cy * C));
+        border_scan(map, trans_e[cy][cx], len,
+            [ax, y0](int i) { return index2d(ax, y0 + i); },
+            [ax, y0](int i) { return index2d(ax + 1, y0 + i); });
+    }
+
+    // Переходы через горизонтальную границу между (cx, cy) и (cx, cy + 1)
+    void border_s(const TMap& map, size_t cx, size_t cy)
+    {
+        int ay = static_cast<int>(cy * C + C - 1);
+        int x0 = static_cast<int>(cx * C), len = static_cast<int>(std::min(C, W - cx * C));
+        border_scan(map, trans_s[cy][cx], len,
+            [ay, x0](int i) { return index2d(x0 + i, ay); },
+            [ay, x0](int i) { return index2d(x0 + i, ay + 1); });
+    }
+
+    // Свободные пары клеток вдоль границы группируются в отрезки: короткий отрезок
+    // даёт переход посередине, длинный - по краям. Диагональные переходы добавляются
+    // только там, где соседние прямые пары заблокированы.
+    template <typename FA, typename FB>
+    void border_scan(const TMap& map, Transitions& trans, int len, FA&& cell_a, FB&& cell_b)
+    {
+        constexpr int LONG_RUN = 6;
+        trans.clear();
+        auto pair_free = [&](int i) { return free_cell(map, cell_a(i)) && free_cell(map, cell_b(i)); };
+        for (int i = 0; i < len;)
+        {
+            if (!pair_free(i))
+            {
+                ++i;
+                continue;
+            }
+            int j = i;
+            while (j + 1 < len && pair_free(j + 1)) ++j;
+            if (j - i + 1 >= LONG_RUN)
+            {
+                trans.emplace_back(cell_a(i), cell_b(i));
+                trans.emplace_back(cell_a(j), cell_b(j));
+            } else
+            {
+                int m = (i + j) / 2;
+                trans.emplace_back(cell_a(m), cell_b(m));
+            }
+            i = j + 1;
+        }
+        for (int i = 0; i + 1 < len; ++i)
+        {
+            if (pair_free(i) || pair_free(i + 1))
+                continue;
+            if (free_cell(map, cell_a(i)) && free_cell(map, cell_b(i + 1)))
+                trans.emplace_back(cell_a(i), cell_b(i + 1));
+            if (free_cell(map, cell_a(i + 1)) && free_cell(map, cell_b(i)))
+                trans.emplace_back(cell_a(i + 1), cell_b(i));
+        }
+    }
+
+    // Диагональные переходы через общий угол четырёх кластеров
+    void corners(const TMap& map, size_t kx, size_t ky)
+    {
+        int x = static_cast<int>(kx * C + C - 1), y = static_cast<int>(ky * C + C - 1);
+        unsigned nw = index2d(x, y), ne = index2d(x + 1, y), sw = index2d(x, y + 1), se = index2d(x + 1, y + 1);
+        trans_d[ky][kx].clear();
+        trans_a[ky][kx].clear();
+        if (!free_cell(map, ne) && !free_cell(map, sw) && free_cell(map, nw) && free_cell(map, se))
+            trans_d[ky][kx].emplace_back(nw, se);
+        if (!free_cell(map, nw) && !free_cell(map, se) && free_cell(map, ne) && free_cell(map, sw))
+            trans_a[ky][kx].emplace_back(ne, sw);
+    }
+
+    // Сбор входов кластера с его границ и расчёт расстояний между ними
+    void cluster_build(const TMap& map, size_t k)
+    {
+        Cluster& cl = clusters[k];
+        for (auto e : cl.ents)
+            slot[e] = NO_SLOT;
+        cl.ents.clear();
+        cl.inter.clear();
+        size_t cx = k % CX, cy = k / CX;
+        auto link = [&](const Transitions& trans, bool first) {
+            for (auto& t : trans)
+            {
+                unsigned own = first ? t.first : t.second, other = first ? t.second : t.first;
+                if (slot[own] == NO_SLOT)
+                {
+                    slot[own] = static_cast<unsigned short>(cl.ents.size());
+                    cl.ents.push_back(own);
+                    cl.inter.emplace_back();
+                }
+                bool diag = own % W != other % W && own / W != other / W;
+                cl.inter[slot[own]].emplace_back(other, diag ? DIAG_COST : STEP_COST);
+            }
+        };
+        if (cx + 1 < CX) link(trans_e[cy][cx], true);
+        if (cx > 0) link(trans_e[cy][cx - 1], false);
+        if (cy + 1 < CY) link(trans_s[cy][cx], true);
+        if (cy > 0) link(trans_s[cy - 1][cx], false);
+        if (cx + 1 < CX && cy + 1 < CY) link(trans_d[cy][cx], true);
+        if (cx > 0 && cy > 0) link(trans_d[cy - 1][cx - 1], false);
+        if (cx > 0 && cy + 1 < CY) link(trans_a[cy][cx - 1], true);
+        if (cx + 1 < CX && cy > 0) link(trans_a[cy - 1][cx], false);
+
+        size_t n = cl.ents.size();
+        cl.dist.assign(n * n, INF);
+        for (size_t i = 0; i < n; ++i)
+        {
+            local_search(map, k, cl.ents[i], NONE);
+            for (size_t j = 0; j < n; ++j)
+                cl.dist[i * n + j] = local_cost(k, cl.ents[j]);
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    // Поиск
+
+    // Дейкстра внутри кластера; при заданной цели - A*, останавливающийся на ней
+    void local_search(const TMap& map, size_t k, unsigned from, unsigned to)
+    {
+        int x0 = static_cast<int>((k % CX) * C), y0 = static_cast<int>((k / CX) * C);
+        int x1 = std::min(x0 + static_cast<int>(C), static_cast<int>(W));
+        int y1 = std::min(y0 + static_cast<int>(C), static_cast<int>(H));
+        local.restart(C * C);
+        auto lid = [x0, y0](int x, int y) { return static_cast<unsigned>((y - y0) * C + (x - x0)); };
+        int fx = static_cast<int>(from % W), fy = static_cast<int>(from / W);
+        unsigned fi = lid(fx, fy);
+        Node& fn = local.get(fi);
+        fn.g = fn.f = 0;
+        local.opened.push(NodePtr(local.nodes.get(), fi));
+        while (!local.opened.empty())
+        {
+            NodePtr cur = local.opened.top();
+            local.opened.pop();
+            cur.pn->closed = true;
+            int cx = x0 + static_cast<int>(cur.id % C), cy = y0 + static_cast<int>(cur.id / C);
+            if (to != NONE && index2d(cx, cy) == to)
+                return;
+            for (auto& dir : dirs)
+            {
+                int nx = cx + dir.x, ny = cy + dir.y;
+                if (nx < x0 || nx >= x1 || ny < y0 || ny >= y1 || map.isobstacle(nx, ny))
+                    continue;
+                unsigned ni = lid(nx, ny);
+                Node& nn = local.get(ni);
+                if (nn.closed)
+                    continue;
+                TWeight g = cur.pn->g + dir.d;
+                if (g >= nn.g)
+                    continue;
+                bool fresh = nn.g >= INF;
+                nn.g = g;
+                nn.parent = cur.id;
+                TWeight f = to == NONE ? g : g + cost_estimate(index2d(nx, ny), to);
+                if (fresh)
+                {
+                    nn.f = f;
+                    local.opened.push(NodePtr(local.nodes.get(), ni));
+                } else
+                    local.opened.decrease(NodePtr(local.nodes.get(), ni), [f](NodePtr& a) { a.pn->f = f; });
+            }
+        }
+    }
+
+    // Стоимость достижения клетки кластера по результатам local_search
+    TWeight local_cost(size_t k, unsigned cell)
+    {
+        int x0 = static_cast<int>((k % CX) * C), y0 = static_cast<int>((k / CX) * C);
+        unsigned li = static_cast<unsigned>((static_cast<int>(cell / W) - y0) * C + (static_cast<int>(cell % W) - x0));
+        Node& n = local.get(li);
+        return n.closed ? n.g : INF;
+    }
+
+    bool abstract_search(const TMap& map, const TCoords& start_p, const TCoords& finish_p, std::vector<unsigned>& waypoints,
+        const std::atomic<bool> *cancel)
+    {
+        const unsigned S_ID = static_cast<unsigned>(CX * CY * MAXE), G_ID = S_ID + 1;
+        unsigned sc = cell_cluster(index2d(start_p.x, start_p.y)), gc = cell_cluster(index2d(finish_p.x, finish_p.y));
+        unsigned start = index2d(start_p.x, start_p.y), finish = index2d(finish_p.x, finish_p.y);
+
+        // Подключение старта и цели к входам их кластеров
+        local_search(map, sc, start, NONE);
+        start_costs.clear();
+        for (auto e : clusters[sc].ents) start_costs.push_back(local_cost(sc, e));
+        TWeight direct = sc == gc ? local_cost(sc, finish) : INF;
+        local_search(map, gc, finish, NONE);
+        finish_costs.clear();
+        for (auto e : clusters[gc].ents) finish_costs.push_back(local_cost(gc, e));
+
+        auto cell_of = [&](unsigned id) -> unsigned {
+            if (id == S_ID) return start;
+            if (id == G_ID) return finish;
+            return clusters[id / MAXE].ents[id % MAXE];
+        };
+
+        abstract.restart(CX * CY * MAXE + 2);
+        Node& sn = abstract.get(S_ID);
+        sn.g = 0;
+        sn.f = cost_estimate(start, finish);
+        abstract.opened.push(NodePtr(abstract.nodes.get(), S_ID));
+        auto relax = [&](unsigned from, unsigned to, TWeight w) {
+            Node& nn = abstract.get(to);
+            if (nn.closed)
+                return;
+            TWeight g = abstract.nodes[from].g + w;
+            if (g >= nn.g)
+                return;
+            bool fresh = nn.g >= INF;
+            nn.g = g;
+            nn.parent = from;
+            TWeight f = g + cost_estimate(cell_of(to), finish);
+            if (fresh)
+            {
+                nn.f = f;
+                abstract.opened.push(NodePtr(abstract.nodes.get(), to));
+            } else
+                abstract.opened.decrease(NodePtr(abstract.nodes.get(), to), [f](NodePtr& a) { a.pn->f = f; });
+        };
+        for (unsigned step = 1; !abstract.opened.empty(); ++step)
+        {
+            if (step % CANCEL_PERIOD == 0 && cancel && cancel->load(std::memory_order_relaxed))
+                return false;
+            NodePtr cur = abstract.opened.top();
+            abstract.opened.pop();
+            cur.pn->closed = true;
+            if (cur.id == G_ID)
+            {
+                for (unsigned id = G_ID; id != NONE; id = abstract.nodes[id].parent)
+                    waypoints.push_back(cell_of(id));
+                std::reverse(waypoints.begin(), waypoints.end());
+                return true;
+            }
+            if (cur.id == S_ID)
+            {
+                for (size_t j = 0; j < start_costs.size(); ++j)
+                    if (start_costs[j] < INF)
+                        relax(S_ID, static_cast<unsigned>(sc * MAXE + j), start_costs[j]);
+                if (direct < INF)
+                    relax(S_ID, G_ID, direct);
+                continue;
+            }
+            unsigned k = cur.id / MAXE, i = cur.id % MAXE;
+            const Cluster& cl = clusters[k];
+            size_t n = cl.ents.size();
+            for (size_t j = 0; j < n; ++j)
+                if (j != i && cl.dist[i * n + j] < INF)
+                    relax(cur.id, static_cast<unsigned>(k * MAXE + j), cl.dist[i * n + j]);
+            for (auto& t : cl.inter[i])
+                relax(cur.id, static_cast<unsigned>(cell_cluster(t.first) * MAXE + slot[t.first]), t.second);
+            if (k == gc && finish_costs[i] < INF)
+                relax(cur.id, G_ID, finish_costs[i]);
+        }
+        return false;
+    }
+
+    // Уточнение отрезка абстрактного пути до последовательности клеток
+    void refine(const TMap& map, unsigned from, unsigned to, std::vector<unsigned>& cells)
+    {
+        if (from == to)
+            return;
+        int dx = static_cast<int>(to % W) - static_cast<int>(from % W);
+        int dy = static_cast<int>(to / W) - static_cast<int>(from / W);
+        if (std::abs(dx) <= 1 && std::abs(dy) <= 1)
+        {
+            cells.push_back(to);
+            return;
+        }
+        size_t k = cell_cluster(from);
+        local_search(map, k, from, to);
+        int x0 = static_cast<int>((k % CX) * C), y0 = static_cast<int>((k / CX) * C);
+        size_t mark = cells.size();
+        unsigned li = static_cast<unsigned>((static_cast<int>(to / W) - y0) * C + (static_cast<int>(to % W) - x0));
+        for (; local.nodes[li].parent != NONE; li = local.nodes[li].parent)
+            cells.push_back(index2d(x0 + static_cast<int>(li % C), y0 + static_cast<int>(li / C)));
+        std::reverse(cells.begin() + mark, cells.end());
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+
+    static unsigned cell_cluster(unsigned cell)
+    {
+        return static_cast<unsigned>((cell / W / C) * CX + (cell % W) / C);
+    }
+
+    static bool free_cell(const TMap& map, unsigned cell)
+    {
+        return !map.isobstacle(static_cast<int>(cell % W), static_cast<int>(cell / W));
+    }
+
+    static unsigned index2d(int x, int y)
+    {
+        return static_cast<unsigned>(y * W + x);
+    }
+
+    // Октильная оценка, согласованная со стоимостями шагов
+    static TWeight cost_estimate(unsigned a, unsigned b)
+    {
+        TWeight dx = std::abs(static_cast<int>(a % W) - static_cast<int>(b % W));
+        TWeight dy = std::abs(static_cast<int>(a / W) - static_cast<int>(b / W));
+        return dx < dy
+            ? DIAG_COST * dx + STEP_COST * (dy - dx)
+            : DIAG_COST * dy + STEP_COST * (dx - dy);
+    }
+
+    static bool inbound(int x, int y)
+    {
+        return x >= 0 && x < static_cast<int>(W) && y >= 0 && y < static_cast<int>(H);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright(c) 2017 https://github.com/mrprint
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
@@ -0,0 +1,246 @@
+﻿#pragma once
+
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include "pathfinding.hpp"
+
+// Jump Point Search для равномерной 8-связной сетки
+// Пропускает прямые участки без раскрытия промежуточных узлов, раскрывая лишь
+// точки прыжка. Модель передвижения та же, что и у AStar: срезание углов
+// допускается, шаг по прямой стоит 10, по диагонали - 19.
+// Возвращает путь в том же формате смещений (в обратном порядке).
+template<
+    size_t H, size_t W, // Размерность карты
+    typename TCoords, // Тип координат, предоставляющий члены "x" и "y". Со знаком
+    typename TMap, // Карта. Предоставляет "isobstacle(x, y)"
+    typename TWeight = int, // Тип веса
+    typename TPath = std::vector<TCoords>, // Возвращаемый путь, предоставляющий push_back
+    template <typename> class TOpened = tool::IndexedOpenList // Открытый список
+>
+class JPSearch : protected AStar<H, W, TCoords, TMap, TWeight, TPath, TOpened>
+{
+    using Base = AStar<H, W, TCoords, TMap, TWeight, TPath, TOpened>;
+    using typename Base::AttrsPtr;
+    using typename Base::Attributes;
+    using Base::index2d;
+    using Base::inbound;
+
+    static constexpr TWeight STEP_COST = tool::GRID_STEP_COST;
+    static constexpr TWeight DIAG_COST = tool::GRID_DIAG_COST;
+
+public:
+
+    // Рабочее пространство, дополненное ссылками на предыдущие точки прыжка
+    struct Workspace : Base::Workspace
+    {
+        std::unique_ptr<unsigned[]> parents; // Индекс предыдущей точки прыжка
+        Workspace() : parents(new unsigned[H * W]) {}
+    };
+
+private:
+
+    std::unique_ptr<Workspace> ws; // Для однопоточного использования, создаётся по требованию
+
+public:
+
+    JPSearch() : Base() {}
+
+    size_t expansions_get() const { return ws ? ws->expansions : 0; }
+
+    // Получить смещения (в обратном порядке)
+    bool search_ofs(TPath& path, const TMap& map, const TCoords& start_p, const TCoords& finish_p)
+    {
+        if (!ws)
+            ws.reset(new Workspace);
+        return search_ofs(*ws, path, map, start_p, finish_p);
+    }
+
+    // То же во внешнем рабочем пространстве. Допускает параллельные вызовы
+    bool search_ofs(Workspace& w, TPath& path, const TMap& map, const TCoords& start_p, const TCoords& finish_p) const
+    {
+        if (!do_search(w, map, start_p, finish_p))
+            return false;
+        get_path_ofs(w, path, start_p, finish_p);
+        return true;
+    }
+
+protected:
+
+    bool do_search(Workspace& w, const TMap& map, const TCoords& start_p, const TCoords& finish_p) const
+    {
+        w.renew();
+
+        AttrsPtr current = Base::opened_push(w, start_p, cost_estimate(start_p, finish_p));
+        current.pa->gscore = 0;
+        w.parents[index2d(start_p.x, start_p.y)] = static_cast<unsigned>(index2d(start_p.x, start_p.y));
+        while (!w.opened.empty())
+        {
+            current = Base::opened_pop(w);
+            if (current.pos.x == finish_p.x && current.pos.y == finish_p.y)
+                return true;
+            ++w.expansions;
+            auto ci = index2d(current.pos.x, current.pos.y);
+            int px = static_cast<int>(w.parents[ci] % W), py = static_cast<int>(w.parents[ci] / W);
+            int dx = sign(current.pos.x - px), dy = sign(current.pos.y - py);
+            if (dx == 0 && dy == 0)
+            {
+                // Стартовая точка раскрывается во всех направлениях
+                for (int y = -1; y <= 1; ++y)
+                    for (int x = -1; x <= 1; ++x)
+                        if (x || y)
+                            successor(w, map, current, x, y, finish_p);
+                continue;
+            }
+            auto x = current.pos.x, y = current.pos.y;
+            if (dx != 0 && dy != 0)
+            {
+                successor(w, map, current, dx, 0, finish_p);
+                successor(w, map, current, 0, dy, finish_p);
+                successor(w, map, current, dx, dy, finish_p);
+                if (blocked(map, x - dx, y))
+                    successor(w, map, current, -dx, dy, finish_p);
+                if (blocked(map, x, y - dy))
+                    successor(w, map, current, dx, -dy, finish_p);
+            } else if (dx != 0)
+            {
+                successor(w, map, current, dx, 0, finish_p);
+                if (blocked(map, x, y + 1))
+                    successor(w, map, current, dx, 1, finish_p);
+                if (blocked(map, x, y - 1))
+                    successor(w, map, current, dx, -1, finish_p);
+            } else
+            {
+                successor(w, map, current, 0, dy, finish_p);
+                if (blocked(map, x + 1, y))
+                    successor(w, map, current, 1, dy, finish_p);
+                if (blocked(map, x - 1, y))
+                    successor(w, map, current, -1, dy, finish_p);
+            }
+        }
+        return false;
+    }
+
+    // Прыжок из текущей точки в заданном направлении и учёт найденной точки
+    void successor(Workspace& w, const TMap& map, const AttrsPtr& current, int dx, int dy, const TCoords& finish_p) const
+    {
+        TCoords jp;
+        if (!jump(map, current.pos, dx, dy, finish_p, jp))
+            return;
+        auto ji = index2d(jp.x, jp.y);
+        Attributes& ja = w.at(ji);
+        if (ja.state == Base::st_Closed)
+            return;
+        int steps = std::max(std::abs(jp.x - current.pos.x), std::abs(jp.y - current.pos.y));
+        TWeight t_gscore = current.pa->gscore + steps * ((dx && dy) ? DIAG_COST : STEP_COST);
+        if (ja.state == Base::st_Wild)
+        {
+            Base::opened_push(w, jp, t_gscore + cost_estimate(jp, finish_p));
+        } else
+        {
+            if (t_gscore >= ja.gscore)
+                return;
+            Base::rearrange(w, jp, t_gscore + cost_estimate(jp, finish_p));
+        }
+        ja.gscore = t_gscore;
+        w.parents[ji] = static_cast<unsigned>(index2d(current.pos.x, current.pos.y));
+    }
+
+    // Поиск ближайшей точки прыжка по направлению
+    bool jump(const TMap& map, const TCoords& from, int dx, int dy, const TCoords& finish_p, TCoords& found) const
+    {
+        int x = from.x, y = from.y;
+        while (true)
+        {
+            x += dx; y += dy;
+            if (!inbound(x, y) || map.isobstacle(x, y))
+                return false;
+            if (x == finish_p.x && y == finish_p.y)
+                break;
+            if (dx != 0 && dy != 0)
+            {
+                if ((blocked(map, x - dx, y) && walkable(map, x - dx, y + dy))
+                    || (blocked(map, x, y - dy) && walkable(map, x + dx, y - dy)))
+                    break;
+                TCoords p; p.x = x; p.y = y;
+                TCoords dummy;
+                if (jump(map, p, dx, 0, finish_p, dummy) || jump(map, p, 0, dy, finish_p, dummy))
+                    break;
+            } else if (dx != 0)
+            {
+                if ((blocked(map, x, y + 1) && walkable(map, x + dx, y + 1))
+                    || (blocked(map, x, y - 1) && walkable(map, x + dx, y - 1)))
+                    break;
+            } else
+            {
+                if ((blocked(map, x + 1, y) && walkable(map, x + 1, y + dy))
+                    || (blocked(map, x - 1, y) && walkable(map, x - 1, y + dy)))
+                    break;
+            }
+        }
+        found.x = x; found.y = y;
+        return true;
+    }
+
+    static void get_path_ofs(const Workspace& w, TPath& path, const TCoords& start_p, const TCoords& finish_p)
+    {
+        size_t ci = index2d(finish_p.x, finish_p.y);
+        size_t si = index2d(start_p.x, start_p.y);
+        while (ci != si)
+        {
+            size_t pi = w.parents[ci];
+            int cx = static_cast<int>(ci % W), cy = static_cast<int>(ci / W);
+            int px = static_cast<int>(pi % W), py = static_cast<int>(pi / W);
+            TCoords p;
+            p.x = sign(cx - px);
+            p.y = sign(cy - py);
+            for (int steps = std::max(std::abs(cx - px), std::abs(cy - py)); steps > 0; --steps)
+                path.push_back(p);
+            ci = pi;
+        }
+    }
+
+    // Октильная оценка, согласованная со стоимостями шагов
+    static TWeight cost_estimate(const TCoords& a, const TCoords& b)
+    {
+        return static_cast<TWeight>(tool::HeuristicOctile()(a, b));
+    }
+
+    // Препятствие в пределах карты (граница карты вынужденных соседей не порождает)
+    static bool blocked(const TMap& map, int x, int y)
+    {
+        return inbound(x, y) && map.isobstacle(x, y);
+    }
+
+    static bool walkable(const TMap& map, int x, int y)
+    {
+        return inbound(x, y) && !map.isobstacle(x, y);
+    }
+
+    static int sign(int v)
+    {
+        return (v > 0) - (v < 0);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright(c) 2017 https://github.com/mrprint
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
@@ -0,0 +1,219 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include <utility>
+#include "gridpolicies.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Оценка расстояния по ориентирам (ALT: A*, Landmarks, Triangle inequality)
+// Для нескольких клеток-ориентиров заранее считаются точные расстояния до всех
+// клеток поля. По неравенству треугольника |d(L, a) - d(L, b)| <= d(a, b), и
+// такая оценка учитывает стены, которые геометрическая оценка не видит.
+// Таблица верна лишь для той ревизии поля, по которой построена; после смены
+// препятствий её следует строить заново, а до тех пор искать без неё.
+////////////////////////////////////////////////////////////////////////////////
+
+namespace tool
+{
+
+    template <
+        std::size_t H, std::size_t W, // Размерность карты
+        typename TCoords, // Тип координат, предоставляющий члены "x" и "y". Со знаком
+        typename TMap, // Карта. Предоставляет "isobstacle(x, y)"
+        std::size_t K, // Число ориентиров
+        typename TNeighbourhood = NeighbourhoodEight // Связность, та же, что и у поиска
+    >
+    class LandmarkTable
+    {
+        using TWeight = int;
+
+        static constexpr TWeight INF = std::numeric_limits<TWeight>::max();
+        static constexpr std::size_t RING = 32; // Корзин в кольце, больше наибольшей стоимости шага
+
+        std::unique_ptr<TWeight[]> dist; // Расстояния: K значений подряд на клетку
+        std::size_t count;
+        unsigned long revision;
+        bool exhausted; // Свободных клеток нет - добавлять ориентиры некуда
+        // Состояние построения, прерываемого между вызовами build_step()
+        std::size_t scan; // Очередная клетка при выборе нового ориентира
+        std::size_t source; // Наиболее удалённая из просмотренных; H * W - нет такой
+        TWeight farthest; // Её расстояние до ближайшего из выбранных ориентиров
+        std::vector<unsigned> buckets[RING]; // Корзины волны строящегося ориентира
+        std::size_t queued; // Записей в корзинах; 0 - волна не идёт
+        TWeight cur; // Обрабатываемая корзина
+
+    public:
+
+        explicit LandmarkTable(unsigned long _revision) :
+            dist(new TWeight[H * W * K]), count(0), revision(_revision), exhausted(false),
+            scan(0), source(H * W), farthest(-1), queued(0), cur(0)
+        {
+            std::fill(dist.get(), dist.get() + H * W * K, INF);
+        }
+
+        // Шаг построения: не более steps клеток (просмотра поля или волны).
+        // Первый ориентир - первая свободная клетка, каждый следующий - клетка,
+        // наиболее удалённая от уже выбранных. Отделённые стенами области,
+        // не покрытые ни одним ориентиром, выбираются в первую очередь.
+        // Построение можно растянуть на сколь угодно много вызовов.
+        // true - таблица построена
+        bool build_step(const TMap& map, std::size_t steps)
+        {
+            while (!complete())
+            {
+                if (queued == 0)
+                {
+                    for (; scan < H * W; ++scan)
+                    {
+                        if (steps == 0)
+                            return false;
+                        --steps;
+                        if (map.isobstacle(static_cast<int>(scan % W), static_cast<int>(scan / W)))
+                            continue;
+                        TWeight nearest = INF;
+                        for (std::size_t l = 0; l < count; ++l)
+                            nearest = std::min(nearest, dist[scan * K + l]);
+                        if (nearest > farthest)
+                        {
+                            farthest = nearest;
+                            source = scan;
+                            if (nearest == INF)
+                                break;
+                        }
+                    }
+                    if (source == H * W || farthest == 0)
+                    {
+                        exhausted = true;
+                        break;
+                    }
+                    dist[source * K + count] = 0;
+                    buckets[0].push_back(static_cast<unsigned>(source));
+                    queued = 1;
+                    cur = 0;
+                }
+                if (!wave_step(map, steps))
+                    return false;
+                ++count;
+                scan = 0;
+                source = H * W;
+                farthest = -1;
+            }
+            for (auto& bucket : buckets)
+                std::vector<unsigned>().swap(bucket); // Готовой таблице корзины не нужны
+            return true;
+        }
+
+        // Построение таблицы целиком
+        void build(const TMap& map)
+        {
+            while (!build_step(map, H * W))
+                ;
+        }
+
+        bool complete() const { return count == K || exhausted; }
+        std::size_t size() const { return count; }
+        unsigned long revision_get() const { return revision; }
+
+        // Нижняя граница стоимости пути между клетками
+        template <typename TC>
+        TWeight estimate(const TC& a, const TC& b) const
+        {
+            const TWeight *da = &dist[index2d(a.x, a.y) * K], *db = &dist[index2d(b.x, b.y) * K];
+            TWeight h = 0;
+            for (std::size_t l = 0; l < count; ++l)
+            {
+                if (da[l] == INF || db[l] == INF)
+                    continue; // Клетка не связана с ориентиром - он ничего не говорит
+                h = std::max(h, std::abs(da[l] - db[l]));
+            }
+            return h;
+        }
+
+    private:
+
+        // Продолжение волны Дейкстры по корзинам для ориентира count, не более
+        // steps клеток. true - волна прошла всё поле
+        bool wave_step(const TMap& map, std::size_t& steps)
+        {
+            const std::size_t l = count;
+            for (; queued > 0; ++cur)
+            {
+                auto& bucket = buckets[cur % RING];
+                while (!bucket.empty())
+                {
+                    if (steps == 0)
+                        return false;
+                    --steps;
+                    unsigned vi = bucket.back();
+                    bucket.pop_back();
+                    --queued;
+                    if (dist[vi * K + l] != cur)
+                        continue; // Устаревшая запись
+                    int vx = static_cast<int>(vi % W), vy = static_cast<int>(vi / W);
+                    TNeighbourhood::expand(map, vx, vy, static_cast<int>(W), static_cast<int>(H),
+                        [&](int dx, int dy, int d)
+                    {
+                        auto ui = index2d(vx + dx, vy + dy);
+                        if (cur + d < dist[ui * K + l])
+                        {
+                            dist[ui * K + l] = cur + d;
+                            buckets[(cur + d) % RING].push_back(static_cast<unsigned>(ui));
+                            ++queued;
+                        }
+                    });
+                }
+            }
+            return true;
+        }
+
+        static std::size_t index2d(int x, int y)
+        {
+            return static_cast<std::size_t>(y) * W + static_cast<std::size_t>(x);
+        }
+    };
+
+    // Оценка для AStar: наибольшая из октильной и оценки по ориентирам.
+    // Без таблицы совпадает с октильной
+    template <typename TTable>
+    struct HeuristicLandmarks
+    {
+        std::shared_ptr<const TTable> table;
+
+        HeuristicLandmarks() {}
+        explicit HeuristicLandmarks(std::shared_ptr<const TTable> _table) : table(std::move(_table)) {}
+
+        template <typename TCoords>
+        int operator()(const TCoords& a, const TCoords& b) const
+        {
+            int h = HeuristicOctile()(a, b);
+            return table ? std::max(h, table->estimate(a, b)) : h;
+        }
+    };
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright(c) 2017 https://github.com/mrprint
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
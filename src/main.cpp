@@ -5,10 +5,10 @@
 
 int main()
 {
-    the_coworker.start();
+    the_executor.start(WORKER_THREADS, JOB_QUEUE_SIZE);
     the_world.setup();
     the_engine.work_do();
-    the_coworker.stop();
+    the_executor.stop(); // Дожидается заданий, ещё читающих поле
     the_world.lists_clear();
     return 0;
 }
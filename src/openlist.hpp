@@ -0,0 +1,183 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <functional>
+
+////////////////////////////////////////////////////////////////////////////////
+// Открытые списки для алгоритмов поиска пути
+//
+// Требования к типу узла TNode:
+//   operator> - порядок приоритетов (меньший считается лучшим);
+//   operator== - идентичность узлов;
+//   heap_pos() - ссылка на хранимый вместе с атрибутами узла индекс в куче.
+// Уменьшение ключа выполняется через функтор, который меняет оценку узла
+// в тот момент, когда это не нарушает упорядоченность контейнера.
+////////////////////////////////////////////////////////////////////////////////
+
+namespace tool
+{
+
+    // Двоичная куча на основе стандартных алгоритмов
+    // Уменьшение ключа - через извлечение всех предшествующих элементов, O(n log n)
+    template <typename TNode>
+    class QueueOpenList
+    {
+        std::vector<TNode> heap;
+        std::vector<TNode> temp_buff; // Для переупорядочивания
+
+    public:
+
+        bool empty() const { return heap.empty(); }
+        std::size_t size() const { return heap.size(); }
+        const TNode& top() const { return heap.front(); }
+        void push(const TNode& node) { heap.push_back(node); std::push_heap(heap.begin(), heap.end(), std::greater<TNode>()); }
+        void pop() { std::pop_heap(heap.begin(), heap.end(), std::greater<TNode>()); heap.pop_back(); }
+        void clear() { heap.clear(); }
+
+        template <typename F>
+        void decrease(const TNode& node, F&& update)
+        {
+            TNode a;
+            while ((a = top()), pop(), !(a == node)) temp_buff.push_back(a);
+            update(a);
+            push(a);
+            while (!temp_buff.empty())
+            {
+                push(temp_buff.back());
+                temp_buff.pop_back();
+            }
+        }
+    };
+
+    // D-арная куча, индексирующая свои элементы
+    // Уменьшение ключа - единственным просеиванием вверх, O(log n)
+    template <typename TNode, std::size_t D = 4>
+    class IndexedOpenList
+    {
+        static_assert(D >= 2, "Heap arity must be at least 2");
+
+        std::vector<TNode> heap;
+
+    public:
+
+        bool empty() const { return heap.empty(); }
+        std::size_t size() const { return heap.size(); }
+        const TNode& top() const { return heap.front(); }
+        void clear() { heap.clear(); }
+
+        void push(const TNode& node)
+        {
+            heap.push_back(node);
+            sift_up(heap.size() - 1);
+        }
+
+        void pop()
+        {
+            TNode last = heap.back();
+            heap.pop_back();
+            if (heap.empty())
+                return;
+            heap[0] = last;
+            sift_down(0);
+        }
+
+        template <typename F>
+        void decrease(const TNode& node, F&& update)
+        {
+            std::size_t i = node.heap_pos();
+            update(heap[i]);
+            sift_up(i);
+        }
+
+        // Произвольное изменение ключа
+        template <typename F>
+        void update(const TNode& node, F&& upd)
+        {
+            std::size_t i = node.heap_pos();
+            upd(heap[i]);
+            if (sift_up(i) == i)
+                sift_down(i);
+        }
+
+        void remove(const TNode& node)
+        {
+            std::size_t i = node.heap_pos();
+            TNode last = heap.back();
+            heap.pop_back();
+            if (i >= heap.size())
+                return;
+            heap[i] = last;
+            if (sift_up(i) == i)
+                sift_down(i);
+        }
+
+    private:
+
+        void place(std::size_t i, const TNode& node)
+        {
+            heap[i] = node;
+            heap[i].heap_pos() = static_cast<unsigned>(i);
+        }
+
+        std::size_t sift_up(std::size_t i)
+        {
+            TNode node = heap[i];
+            while (i > 0)
+            {
+                std::size_t p = (i - 1) / D;
+                if (!(heap[p] > node))
+                    break;
+                place(i, heap[p]);
+                i = p;
+            }
+            place(i, node);
+            return i;
+        }
+
+        void sift_down(std::size_t i)
+        {
+            TNode node = heap[i];
+            const std::size_t n = heap.size();
+            while (true)
+            {
+                std::size_t c = i * D + 1;
+                if (c >= n)
+                    break;
+                std::size_t best = c;
+                std::size_t ce = c + D < n ? c + D : n;
+                for (++c; c < ce; ++c)
+                    if (heap[best] > heap[c])
+                        best = c;
+                if (!(node > heap[best]))
+                    break;
+                place(i, heap[best]);
+                i = best;
+            }
+            place(i, node);
+        }
+    };
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright(c) 2017 https://github.com/mrprint
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
@@ -0,0 +1,171 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////
+// Путь в сжатом виде
+// Отрезок по одному из восьми направлений хранится одним байтом: 3 бита кода
+// направления и 5 бит длины (1..31 клеток). Подряд идущие шаги в одном
+// направлении сливаются в один отрезок. Прочие смещения (после спрямления
+// путь может идти под любым углом) записываются с признаком длины 0 и
+// двумя 16-битными координатами следом.
+// В отличие от путей AStar отрезки хранятся в порядке движения.
+////////////////////////////////////////////////////////////////////////////////
+
+namespace tool
+{
+
+    template <typename TCoords> // Тип координат, предоставляющий члены "x" и "y". Со знаком
+    class PackedPath
+    {
+        static constexpr unsigned RUN_BITS = 5;
+        static constexpr unsigned RUN_MAX = (1u << RUN_BITS) - 1;
+        static constexpr std::size_t NO_TOKEN = static_cast<std::size_t>(-1);
+
+        static constexpr struct { int x, y; } dirs[] =
+        { { -1, -1 },{ 0, -1 },{ 1, -1 },{ -1, 0 },{ 1, 0 },{ -1, 1 },{ 0, 1 },{ 1, 1 } };
+
+        std::vector<std::uint8_t> bytes;
+        std::size_t last; // Последний байт направления, который ещё можно удлинить
+
+    public:
+
+        // Перебор отрезков в порядке движения
+        class const_iterator
+        {
+            const std::uint8_t *p;
+
+        public:
+
+            const_iterator() : p(nullptr) {}
+            explicit const_iterator(const std::uint8_t *_p) : p(_p) {}
+
+            TCoords operator*() const { return decode(p); }
+            const_iterator& operator++() { p += (*p & RUN_MAX) ? 1 : 5; return *this; }
+            bool operator==(const const_iterator& r) const { return p == r.p; }
+            bool operator!=(const const_iterator& r) const { return p != r.p; }
+        };
+
+        PackedPath() : last(NO_TOKEN) {}
+
+        // Заполнение из смещений в обратном порядке (формат AStar)
+        template <typename TPath>
+        void assign_ofs(const TPath& path)
+        {
+            clear();
+            for (auto it = path.rbegin(); it != path.rend(); ++it)
+                push_back(it->x, it->y);
+        }
+
+        // Добавление отрезка в конец пути
+        void push_back(int dx, int dy)
+        {
+            const int ax = std::abs(dx), ay = std::abs(dy);
+            if (ax == 0 && ay == 0)
+                return;
+            if (ax != 0 && ay != 0 && ax != ay)
+            {
+                // Не по одному из восьми направлений
+                last = NO_TOKEN;
+                bytes.push_back(0);
+                word_push(dx);
+                word_push(dy);
+                return;
+            }
+            const int run = ax > ay ? ax : ay;
+            const unsigned code = dir_code(dx / run, dy / run);
+            for (unsigned left = static_cast<unsigned>(run); left > 0; )
+            {
+                if (last != NO_TOKEN && (bytes[last] >> RUN_BITS) == code && (bytes[last] & RUN_MAX) < RUN_MAX)
+                {
+                    unsigned add = RUN_MAX - (bytes[last] & RUN_MAX);
+                    add = add < left ? add : left;
+                    bytes[last] = static_cast<std::uint8_t>(bytes[last] + add);
+                    left -= add;
+                    continue;
+                }
+                last = bytes.size();
+                bytes.push_back(static_cast<std::uint8_t>(code << RUN_BITS));
+            }
+        }
+
+        void clear()
+        {
+            bytes.clear();
+            last = NO_TOKEN;
+        }
+
+        void swap(PackedPath& r)
+        {
+            bytes.swap(r.bytes);
+            std::swap(last, r.last);
+        }
+
+        bool empty() const { return bytes.empty(); }
+        std::size_t size_bytes() const { return bytes.size(); }
+        const_iterator begin() const { return const_iterator(bytes.data()); }
+        const_iterator end() const { return const_iterator(bytes.data() + bytes.size()); }
+
+    private:
+
+        static unsigned dir_code(int dx, int dy)
+        {
+            const unsigned k = static_cast<unsigned>((dy + 1) * 3 + (dx + 1)); // 0..8 без центра
+            return k > 4 ? k - 1 : k;
+        }
+
+        void word_push(int v)
+        {
+            const std::uint16_t w = static_cast<std::uint16_t>(static_cast<std::int16_t>(v));
+            bytes.push_back(static_cast<std::uint8_t>(w & 0xff));
+            bytes.push_back(static_cast<std::uint8_t>(w >> 8));
+        }
+
+        static int word_get(const std::uint8_t *p)
+        {
+            return static_cast<std::int16_t>(static_cast<std::uint16_t>(p[0] | (p[1] << 8)));
+        }
+
+        static TCoords decode(const std::uint8_t *p)
+        {
+            TCoords ofs;
+            const unsigned run = *p & RUN_MAX;
+            if (run == 0)
+            {
+                ofs.x = word_get(p + 1);
+                ofs.y = word_get(p + 3);
+            } else
+            {
+                ofs.x = dirs[*p >> RUN_BITS].x * static_cast<int>(run);
+                ofs.y = dirs[*p >> RUN_BITS].y * static_cast<int>(run);
+            }
+            return ofs;
+        }
+    };
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright(c) 2017 https://github.com/mrprint
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
@@ -0,0 +1,198 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include "anyangle.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Кэш найденных путей с вытеснением давно не использованных
+// Ключ - пара клеток "старт, цель"; кэш действителен для одной ревизии поля.
+// Появление препятствия удаляет лишь пути, проходящие через клетку: остальные
+// остаются проходимыми и оптимальными. Освобождение клетки может сократить
+// любой путь, поэтому сбрасывает кэш целиком. Если ревизия поля сменилась
+// без уведомления, кэш также сбрасывается при ближайшем обращении.
+////////////////////////////////////////////////////////////////////////////////
+
+namespace tool
+{
+
+    template <
+        std::size_t H, std::size_t W, // Размерность карты
+        typename TCoords, // Тип координат, предоставляющий члены "x" и "y". Со знаком
+        typename TPath // Путь, перебираемый по отрезкам в порядке движения (см. PackedPath)
+    >
+    class PathCache
+    {
+        using Key = std::uint64_t;
+
+        struct Entry
+        {
+            Key key;
+            TPath path;
+            std::vector<unsigned> cells; // Клетки, через которые проходит путь
+        };
+
+        using Entries = std::list<Entry>; // В начале - недавно использованные
+
+        Entries entries;
+        std::unordered_map<Key, typename Entries::iterator> index;
+        std::vector<std::vector<Key>> through; // Обратный индекс: клетка -> ключи путей
+        std::size_t capacity;
+        unsigned long revision;
+        std::size_t hits, misses;
+
+    public:
+
+        explicit PathCache(std::size_t _capacity) :
+            through(H * W), capacity(_capacity), revision(0), hits(0), misses(0) {}
+
+        bool lookup(const TCoords& start_p, const TCoords& finish_p, unsigned long _revision, TPath& path)
+        {
+            sync(_revision);
+            auto it = index.find(key_make(start_p, finish_p));
+            if (it == index.end())
+            {
+                ++misses;
+                return false;
+            }
+            ++hits;
+            entries.splice(entries.begin(), entries, it->second);
+            path = it->second->path;
+            return true;
+        }
+
+        void store(const TCoords& start_p, const TCoords& finish_p, unsigned long _revision, const TPath& path)
+        {
+            if (_revision != revision)
+            {
+                if (_revision < revision)
+                    return; // Путь рассчитан для устаревшего поля
+                sync(_revision);
+            }
+            Key key = key_make(start_p, finish_p);
+            auto it = index.find(key);
+            if (it != index.end())
+                erase(it->second);
+            if (capacity == 0)
+                return;
+            if (entries.size() >= capacity)
+                erase(std::prev(entries.end()));
+            entries.push_front(Entry{ key, path, cells_collect(start_p, path) });
+            index[key] = entries.begin();
+            for (auto ci : entries.front().cells)
+                through[ci].push_back(key);
+        }
+
+        // Уведомление о смене проходимости клетки; _revision - ревизия поля после смены
+        void cell_changed(const TCoords& pos, bool blocked, unsigned long _revision)
+        {
+            if (!blocked || _revision != revision + 1)
+            {
+                sync(_revision);
+                return;
+            }
+            revision = _revision;
+            auto keys = through[index2d(pos.x, pos.y)]; // Копия: erase() правит исходный список
+            for (auto key : keys)
+            {
+                auto it = index.find(key);
+                if (it != index.end())
+                    erase(it->second);
+            }
+        }
+
+        void clear()
+        {
+            entries.clear();
+            index.clear();
+            for (auto& keys : through)
+                keys.clear();
+        }
+
+        std::size_t size() const { return entries.size(); }
+        std::size_t hits_get() const { return hits; }
+        std::size_t misses_get() const { return misses; }
+
+    private:
+
+        void sync(unsigned long _revision)
+        {
+            if (_revision == revision)
+                return;
+            clear();
+            revision = _revision;
+        }
+
+        void erase(typename Entries::iterator it)
+        {
+            for (auto ci : it->cells)
+            {
+                auto& keys = through[ci];
+                auto k = std::find(keys.begin(), keys.end(), it->key);
+                if (k != keys.end())
+                {
+                    *k = keys.back();
+                    keys.pop_back();
+                }
+            }
+            index.erase(it->key);
+            entries.erase(it);
+        }
+
+        static std::vector<unsigned> cells_collect(const TCoords& start_p, const TPath& path)
+        {
+            std::vector<unsigned> cells;
+            int x = start_p.x, y = start_p.y;
+            cells.push_back(index2d(x, y));
+            for (const TCoords& ofs : path)
+            {
+                // Смещение может охватывать несколько клеток под любым углом
+                segment_walk(x, y, x + ofs.x, y + ofs.y, [&cells](int cx, int cy)
+                {
+                    cells.push_back(index2d(cx, cy));
+                    return true;
+                });
+                x += ofs.x;
+                y += ofs.y;
+            }
+            return cells;
+        }
+
+        static Key key_make(const TCoords& start_p, const TCoords& finish_p)
+        {
+            return static_cast<Key>(index2d(start_p.x, start_p.y)) * static_cast<Key>(H * W)
+                + static_cast<Key>(index2d(finish_p.x, finish_p.y));
+        }
+
+        static unsigned index2d(int x, int y)
+        {
+            return static_cast<unsigned>(y * W + x);
+        }
+    };
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright(c) 2017 https://github.com/mrprint
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
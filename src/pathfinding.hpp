@@ -4,16 +4,26 @@
 #include <cmath>
 #include <functional>
 #include <algorithm>
+#include <iterator>
 #include <vector>
 #include <queue>
 #include <memory>
+#include <limits>
+#include <atomic>
+#include "openlist.hpp"
+#include "gridpolicies.hpp"
+#include "workspool.hpp"
 
 template<
     size_t H, size_t W, // Размерность карты
     typename TCoords, // Тип координат, предоставляющий члены "x" и "y". Со знаком
     typename TMap, // Карта. Предоставляет "isobstacle(x, y)"
     typename TWeight = int, // Тип веса
-    typename TPath = std::vector<TCoords> // Возвращаемый путь, предоставляющий push_back
+    typename TPath = std::vector<TCoords>, // Возвращаемый путь, предоставляющий push_back
+    template <typename> class TOpened = tool::IndexedOpenList, // Открытый список
+    typename THeuristic = tool::HeuristicSquared, // Оценка расстояния (см. gridpolicies.hpp)
+    typename TNeighbourhood = tool::NeighbourhoodEight, // Связность (см. gridpolicies.hpp)
+    typename TLayout = tool::LayoutRowMajor // Размещение узлов в памяти (см. gridpolicies.hpp)
 >
 class AStar
 {
@@ -25,16 +35,21 @@ protected:
         st_Closed
     };
 
-    struct Attributes // Атрибуты позиции
+    static constexpr size_t NODES = TLayout::template size<H, W>(); // Длина массивов узлов
+    static constexpr unsigned EPOCH_LIMIT = 1u << 30; // Поколение умещается в 30 бит
+    static constexpr size_t CANCEL_PERIOD = 8; // Раскрытий между проверками флага отмены
+
+    // Атрибуты позиции, нужные при раскрытии узлов и в открытом списке.
+    // Направление на предыдущую клетку читается лишь при сборке пути
+    // и хранится отдельно (см. Workspace::links)
+    struct Attributes
     {
         TWeight fscore, gscore;
-        char ofsx;
-        char ofsy;
-        unsigned char state;
+        unsigned heap_idx; // Позиция в открытом списке
+        unsigned state : 2;
+        unsigned epoch : 30; // Поколение поиска, в котором атрибуты были заполнены
     };
 
-    std::unique_ptr<Attributes[]> attrs;
-
     struct AttrsPtr // Координаты и ссылка на атрибуты
     {
         Attributes *pa;
@@ -42,123 +57,421 @@ protected:
         AttrsPtr() noexcept { /* NO MEMBERS INIT */ };
         AttrsPtr(const TCoords& p, Attributes *attrs) noexcept { pos = p; pa = &attrs[index2d(pos.x, pos.y)]; }
         bool operator> (const AttrsPtr& r) const { return r.pa->fscore < pa->fscore; }
+        bool operator== (const AttrsPtr& r) const { return pa == r.pa; }
+        unsigned& heap_pos() const { return pa->heap_idx; }
     };
 
-    std::priority_queue<AttrsPtr, std::vector<AttrsPtr>, std::greater<AttrsPtr> > opened;
-    std::vector<AttrsPtr> temp_buff; // Для переупорядочивания
+public:
+
+    // Рабочее пространство поиска
+    // Сбрасывается сменой поколения: атрибуты чужого поколения считаются нетронутыми,
+    // поэтому поиск обходится во столько, сколько клеток он затронул.
+    // Одновременно одним пространством может пользоваться лишь один поиск.
+    struct Workspace
+    {
+        std::unique_ptr<Attributes[]> attrs;
+        std::unique_ptr<unsigned char[]> links; // Направление на предыдущую клетку (см. link_make)
+        TOpened<AttrsPtr> opened;
+        unsigned epoch;
+        size_t expansions; // Число раскрытых узлов в последнем поиске
+        TCoords start_p, finish_p; // Концы пошагового поиска
+        TCoords nearest_p; // Закрытая клетка с наименьшей оценкой расстояния до цели
+        TWeight nearest_h;
+        std::vector<TCoords> goals; // Цели многоцелевого поиска; пусто - единственная finish_p
+        const std::atomic<bool> *cancel; // Флаг отмены, выставляемый другим потоком; nullptr - без отмены
+
+        Workspace() : attrs(new Attributes[NODES]), links(new unsigned char[NODES]), epoch(0), expansions(0), cancel(nullptr)
+        {
+            memset(attrs.get(), 0, sizeof(Attributes) * NODES);
+        }
+
+        void renew()
+        {
+            opened.clear();
+            expansions = 0;
+            if (++epoch == EPOCH_LIMIT)
+            {
+                // Счётчик поколений переполнился - единственный раз очищаем всё
+                memset(attrs.get(), 0, sizeof(Attributes) * NODES);
+                epoch = 1;
+            }
+        }
+
+        // Атрибуты клетки, приведённые к текущему поколению
+        Attributes& at(size_t i)
+        {
+            Attributes& a = attrs[i];
+            if (a.epoch != epoch)
+            {
+                a.state = st_Wild;
+                a.epoch = epoch;
+            }
+            return a;
+        }
+    };
+
+protected:
+
+    THeuristic heuristic;
+    std::unique_ptr<Workspace> ws; // Для однопоточного использования, создаётся по требованию
+    std::unique_ptr<Workspace> ws_rev; // Для обратной волны двунаправленного поиска
 
 public:
 
-    AStar() : attrs(new Attributes[H * W]) { temp_buff.reserve(H + W); }
+    // Состояние пошагового поиска
+    enum SearchStatus {
+        ssRUNNING,
+        ssFOUND,
+        ssFAILED,
+        ssCANCELLED // Выставлен флаг отмены рабочего пространства
+    };
+
+    AStar() {}
+    explicit AStar(const THeuristic& _heuristic) : heuristic(_heuristic) {}
+
+    // Смена оценки (например, таблицы ориентиров под новую ревизию поля).
+    // Не допускается во время поиска
+    void heuristic_set(const THeuristic& _heuristic) { heuristic = _heuristic; }
+
+    size_t expansions_get() const { return ws ? ws->expansions : 0; }
 
     // Получить смещения (в обратном порядке)
     bool search_ofs(TPath& path, const TMap& map, const TCoords& start_p, const TCoords& finish_p)
     {
-        if (!do_search(map, start_p, finish_p))
-            return false;
-        get_path_ofs(path, start_p, finish_p);
-        return true;
+        return search_ofs(own_ws(), path, map, start_p, finish_p);
+    }
+
+    // Поиск с запасной целью: если цель недостижима, путь ведёт к закрытой клетке,
+    // ближайшей к ней по оценке (возможно, пустой - старт и есть ближайшая).
+    // Возвращает true, если достигнута сама цель
+    bool search_nearest_ofs(TPath& path, const TMap& map, const TCoords& start_p, const TCoords& finish_p)
+    {
+        return search_nearest_ofs(own_ws(), path, map, start_p, finish_p);
+    }
+
+    // Многоцелевой поиск: смещения (в обратном порядке) до ближайшей из целей
+    template <typename TGoals>
+    bool search_multi_ofs(TPath& path, const TMap& map, const TCoords& start_p, const TGoals& goals, TCoords& reached_p)
+    {
+        return search_multi_ofs(own_ws(), path, map, start_p, goals, reached_p);
     }
 
     // Получить абсолютные координаты (в обратном порядке)
     bool search(TPath& path, const TMap& map, const TCoords& start_p, const TCoords& finish_p)
     {
-        if (!do_search(map, start_p, finish_p))
+        if (!do_search(own_ws(), map, start_p, finish_p))
             return false;
-        get_path(path, start_p, finish_p);
+        get_path(*ws, path, start_p, finish_p);
         return true;
     }
 
-protected:
+    // Двунаправленный поиск: смещения (в обратном порядке)
+    // Оптимальность пути гарантируется лишь при согласованной оценке (например, октильной)
+    bool search_bidir_ofs(TPath& path, const TMap& map, const TCoords& start_p, const TCoords& finish_p)
+    {
+        if (!ws_rev)
+            ws_rev.reset(new Workspace);
+        return search_bidir_ofs(own_ws(), *ws_rev, path, map, start_p, finish_p);
+    }
+
+    // То же во внешнем рабочем пространстве. Допускает параллельные вызовы
+    // с разными пространствами (см. tool::WorkspacePool)
+    bool search_ofs(Workspace& w, TPath& path, const TMap& map, const TCoords& start_p, const TCoords& finish_p) const
+    {
+        if (!do_search(w, map, start_p, finish_p))
+            return false;
+        get_path_ofs(w, path, start_p, finish_p);
+        return true;
+    }
+
+    bool search_nearest_ofs(Workspace& w, TPath& path, const TMap& map, const TCoords& start_p, const TCoords& finish_p) const
+    {
+        bool found = do_search(w, map, start_p, finish_p);
+        get_path_ofs(w, path, start_p, found ? finish_p : w.nearest_p);
+        return found;
+    }
+
+    // Путь к ближайшей из нескольких целей за один проход. Оценка - наименьшая
+    // из оценок до каждой цели и остаётся допустимой; её цена растёт с числом целей,
+    // поэтому их должно быть немного. Достигнутая цель возвращается в reached_p
+    template <typename TGoals>
+    bool search_multi_ofs(Workspace& w, TPath& path, const TMap& map, const TCoords& start_p, const TGoals& goals, TCoords& reached_p) const
+    {
+        search_begin_multi(w, start_p, goals);
+        if (search_step(w, map, std::numeric_limits<size_t>::max()) != ssFOUND)
+            return false;
+        reached_p = w.finish_p;
+        get_path_ofs(w, path, start_p, reached_p);
+        return true;
+    }
 
-    bool do_search(const TMap& map, const TCoords& start_p, const TCoords& finish_p)
+    // Пошаговый поиск: подготовка. Далее search_step() до завершения
+    void search_begin(Workspace& w, const TCoords& start_p, const TCoords& finish_p) const
     {
-        static struct { int x, y, d; } dirs[] =
-        { { -1, -1, 19 },{ 0, -1, 10 },{ 1, -1, 19 },{ -1, 0, 10 },{ 1, 0, 10 },{ -1, 1, 19 },{ 0, 1, 10 },{ 1, 1, 19 } };
-        memset(attrs.get(), 0, sizeof(Attributes) * H * W);
-        while (!opened.empty()) opened.pop();
+        w.renew();
+        w.goals.clear();
+        w.finish_p = finish_p;
+        start_push(w, start_p);
+    }
 
-        AttrsPtr current = opened_push(start_p, cost_estimate(start_p, finish_p));
-        while (!opened.empty())
+    // То же для нескольких целей. По завершении со статусом ssFOUND
+    // достигнутая цель - в finish_p рабочего пространства
+    template <typename TGoals>
+    void search_begin_multi(Workspace& w, const TCoords& start_p, const TGoals& goals) const
+    {
+        w.renew();
+        w.goals.assign(std::begin(goals), std::end(goals));
+        w.finish_p = start_p;
+        if (w.goals.empty())
         {
-            current = opened_pop();
-            if (current.pos.x == finish_p.x && current.pos.y == finish_p.y)
-                return true;
-            for (int i = 0; i < 8; ++i)
+            // Открытый список пуст - поиск сразу завершится неудачей
+            w.start_p = w.nearest_p = start_p;
+            return;
+        }
+        start_push(w, start_p);
+    }
+
+    // Продолжение поиска не более чем на max_steps извлечений из открытого списка.
+    // Карта между вызовами меняться не должна. Флаг отмены проверяется
+    // раз в CANCEL_PERIOD раскрытий; отменённый поиск продолжать нельзя
+    SearchStatus search_step(Workspace& w, const TMap& map, size_t max_steps) const
+    {
+        for (; max_steps > 0; --max_steps)
+        {
+            if (w.opened.empty())
+                return ssFAILED;
+            AttrsPtr current = opened_pop(w);
+            if (goal_reached(w, current.pos))
             {
-                auto dx = dirs[i].x;
-                auto dy = dirs[i].y;
-                TCoords npos;
-                npos.x = current.pos.x + dx;
-                npos.y = current.pos.y + dy;
-                if (!inbound(npos.x, npos.y) || map.isobstacle(npos.x, npos.y))
-                    continue;
-                auto ni = index2d(npos.x, npos.y);
-                if (attrs[ni].state == st_Closed)
-                    continue;
-                TWeight t_gscore = current.pa->gscore + dirs[i].d;
-                if (attrs[ni].state == st_Wild)
-                {
-                    opened_push(npos, t_gscore + cost_estimate(npos, finish_p));
-                } else
-                {
-                    if (t_gscore >= attrs[ni].gscore)
-                        continue;
-                    rearrange(&attrs[ni], t_gscore + cost_estimate(npos, finish_p));
-                }
-                attrs[ni].ofsx = dx;
-                attrs[ni].ofsy = dy;
-                attrs[ni].gscore = t_gscore;
+                w.finish_p = current.pos;
+                return ssFOUND;
             }
+            // Оценка уже входит в ключ; при равенстве ближе та, что найдена раньше
+            TWeight h = current.pa->fscore - current.pa->gscore;
+            if (h < w.nearest_h)
+            {
+                w.nearest_h = h;
+                w.nearest_p = current.pos;
+            }
+            if (++w.expansions % CANCEL_PERIOD == 0 && w.cancel && w.cancel->load(std::memory_order_relaxed))
+                return ssCANCELLED;
+            expand(w, map, current);
         }
-        return false;
+        return w.opened.empty() ? ssFAILED : ssRUNNING;
     }
 
-    AttrsPtr opened_push(const TCoords& p)
+    // Смещения (в обратном порядке) после завершения со статусом ssFOUND
+    void search_result_ofs(const Workspace& w, TPath& path) const
     {
-        AttrsPtr a(p, attrs.get()); opened.push(a); a.pa->state = st_Opened; return a;
+        get_path_ofs(w, path, w.start_p, w.finish_p);
     }
 
-    AttrsPtr opened_push(const TCoords& s, TWeight score)
+    // Смещения к ближайшей к цели клетке после завершения со статусом ssFAILED
+    void search_result_nearest_ofs(const Workspace& w, TPath& path) const
     {
-        AttrsPtr a(s, attrs.get()); a.pa->fscore = score; opened.push(a); a.pa->state = st_Opened; return a;
+        get_path_ofs(w, path, w.start_p, w.nearest_p);
     }
 
-    AttrsPtr opened_pop()
+    bool search_bidir_ofs(Workspace& wf, Workspace& wr, TPath& path, const TMap& map, const TCoords& start_p, const TCoords& finish_p) const
     {
-        AttrsPtr a = opened.top(); opened.pop(); a.pa->state = st_Closed; return a;
+        TCoords meet_p;
+        if (!do_search_bidir(wf, wr, map, start_p, finish_p, meet_p))
+            return false;
+        // Участок от точки встречи до цели - по ссылкам обратной волны
+        size_t from = path.size();
+        for (TCoords p = meet_p; p.x != finish_p.x || p.y != finish_p.y; )
+        {
+            TCoords ofs = link_ofs(wr.links[index2d(p.x, p.y)]);
+            path.push_back(ofs);
+            p.x += ofs.x;
+            p.y += ofs.y;
+        }
+        std::reverse(path.begin() + from, path.end());
+        get_path_ofs(wf, path, start_p, meet_p);
+        return true;
+    }
+
+protected:
+
+    Workspace& own_ws()
+    {
+        if (!ws)
+            ws.reset(new Workspace);
+        return *ws;
+    }
+
+    bool do_search(Workspace& w, const TMap& map, const TCoords& start_p, const TCoords& finish_p) const
+    {
+        search_begin(w, start_p, finish_p);
+        return search_step(w, map, std::numeric_limits<size_t>::max()) == ssFOUND;
     }
 
-    void rearrange(Attributes *attr, TWeight score)
+    void start_push(Workspace& w, const TCoords& start_p) const
     {
-        AttrsPtr a;
-        while ((a = opened.top()), opened.pop(), (a.pa != attr)) temp_buff.push_back(a);
-        a.pa->fscore = score;
-        opened.push(a);
-        while (!temp_buff.empty())
+        w.start_p = start_p;
+        w.nearest_p = start_p;
+        w.nearest_h = goal_estimate(w, start_p);
+        opened_push(w, start_p, w.nearest_h).pa->gscore = 0;
+    }
+
+    TWeight goal_estimate(const Workspace& w, const TCoords& p) const
+    {
+        if (w.goals.empty())
+            return cost_estimate(p, w.finish_p);
+        TWeight h = std::numeric_limits<TWeight>::max();
+        for (const auto& g : w.goals)
+            h = std::min(h, cost_estimate(p, g));
+        return h;
+    }
+
+    static bool goal_reached(const Workspace& w, const TCoords& p)
+    {
+        if (w.goals.empty())
+            return p.x == w.finish_p.x && p.y == w.finish_p.y;
+        for (const auto& g : w.goals)
+            if (p.x == g.x && p.y == g.y)
+                return true;
+        return false;
+    }
+
+    void expand(Workspace& w, const TMap& map, const AttrsPtr& current) const
+    {
+        TNeighbourhood::expand(map, current.pos.x, current.pos.y, static_cast<int>(W), static_cast<int>(H),
+            [&](int dx, int dy, int d)
         {
-            opened.push(temp_buff.back());
-            temp_buff.pop_back();
+            TCoords npos;
+            npos.x = current.pos.x + dx;
+            npos.y = current.pos.y + dy;
+            auto ni = index2d(npos.x, npos.y);
+            Attributes& na = w.at(ni);
+            if (na.state == st_Closed)
+                return;
+            TWeight t_gscore = current.pa->gscore + d;
+            if (na.state == st_Wild)
+            {
+                opened_push(w, npos, t_gscore + goal_estimate(w, npos));
+            } else
+            {
+                if (t_gscore >= na.gscore)
+                    return;
+                rearrange(w, npos, t_gscore + goal_estimate(w, npos));
+            }
+            w.links[ni] = link_make(dx, dy);
+            na.gscore = t_gscore;
+        });
+    }
+
+    // Двунаправленный поиск со сбалансированными потенциалами:
+    // ключ прямой волны 2g + h(v, цель) - h(старт, v), обратной - симметрично.
+    // Сумма ключей в точке встречи равна удвоенной длине пути, поэтому поиск
+    // завершается, когда сумма наименьших ключей двух волн достигает 2 * best.
+    bool do_search_bidir(Workspace& wf, Workspace& wr, const TMap& map, const TCoords& start_p, const TCoords& finish_p, TCoords& meet_p) const
+    {
+        if (map.isobstacle(start_p.x, start_p.y))
+        {
+            // Из препятствия можно лишь выйти - обратная волна его не достигнет
+            meet_p = finish_p;
+            return do_search(wf, map, start_p, finish_p);
         }
+        wf.renew();
+        wr.renew();
+        if (map.isobstacle(finish_p.x, finish_p.y))
+            return false;
+        meet_p = start_p;
+        if (start_p.x == finish_p.x && start_p.y == finish_p.y)
+            return true;
+
+        opened_push(wf, start_p, bidir_key(0, start_p, start_p, finish_p)).pa->gscore = 0;
+        opened_push(wr, finish_p, bidir_key(0, finish_p, finish_p, start_p)).pa->gscore = 0;
+        TWeight best = std::numeric_limits<TWeight>::max() / 4;
+        const TWeight none = best;
+        while (!wf.opened.empty() && !wr.opened.empty())
+        {
+            if (wf.opened.top().pa->fscore + wr.opened.top().pa->fscore >= 2 * best)
+                break;
+            // Раскрываем волну с меньшим фронтом
+            if (wf.opened.size() <= wr.opened.size())
+                bidir_expand(wf, wr, map, start_p, finish_p, 1, best, meet_p);
+            else
+                bidir_expand(wr, wf, map, finish_p, start_p, -1, best, meet_p);
+        }
+        wf.expansions += wr.expansions;
+        return best < none;
+    }
+
+    // Раскрытие узла одной из волн. Прямая волна хранит смещение входа в клетку,
+    // обратная (sign = -1) - смещение выхода из неё в сторону цели
+    void bidir_expand(Workspace& own, Workspace& other, const TMap& map, const TCoords& from_p, const TCoords& to_p,
+        int sign, TWeight& best, TCoords& meet_p) const
+    {
+        AttrsPtr current = opened_pop(own);
+        ++own.expansions;
+        TNeighbourhood::expand(map, current.pos.x, current.pos.y, static_cast<int>(W), static_cast<int>(H),
+            [&](int dx, int dy, int d)
+        {
+            TCoords npos;
+            npos.x = current.pos.x + dx;
+            npos.y = current.pos.y + dy;
+            auto ni = index2d(npos.x, npos.y);
+            Attributes& na = own.at(ni);
+            if (na.state == st_Closed)
+                return;
+            TWeight t_gscore = current.pa->gscore + d;
+            if (na.state == st_Wild)
+            {
+                opened_push(own, npos, bidir_key(t_gscore, npos, from_p, to_p));
+            } else
+            {
+                if (t_gscore >= na.gscore)
+                    return;
+                rearrange(own, npos, bidir_key(t_gscore, npos, from_p, to_p));
+            }
+            own.links[ni] = link_make(sign * dx, sign * dy);
+            na.gscore = t_gscore;
+            const Attributes& oa = other.at(ni);
+            if (oa.state != st_Wild && t_gscore + oa.gscore < best)
+            {
+                best = t_gscore + oa.gscore;
+                meet_p = npos;
+            }
+        });
+    }
+
+    TWeight bidir_key(TWeight gscore, const TCoords& p, const TCoords& from_p, const TCoords& to_p) const
+    {
+        return 2 * gscore + cost_estimate(p, to_p) - cost_estimate(from_p, p);
     }
 
-    void get_path_ofs(TPath& path, const TCoords& start_p, const TCoords& finish_p) const
+    static AttrsPtr opened_push(Workspace& w, const TCoords& s, TWeight score)
     {
-        size_t ci = index2d(finish_p.x, finish_p.y);
-        size_t si = index2d(start_p.x, start_p.y);
-        while (ci != si)
+        AttrsPtr a(s, w.attrs.get()); w.at(index2d(s.x, s.y)); a.pa->fscore = score; w.opened.push(a); a.pa->state = st_Opened; return a;
+    }
+
+    static AttrsPtr opened_pop(Workspace& w)
+    {
+        AttrsPtr a = w.opened.top(); w.opened.pop(); a.pa->state = st_Closed; return a;
+    }
+
+    static void rearrange(Workspace& w, const TCoords& p, TWeight score)
+    {
+        w.opened.decrease(AttrsPtr(p, w.attrs.get()), [score](AttrsPtr& a) { a.pa->fscore = score; });
+    }
+
+    static void get_path_ofs(const Workspace& w, TPath& path, const TCoords& start_p, const TCoords& finish_p)
+    {
+        TCoords p = finish_p;
+        while (p.x != start_p.x || p.y != start_p.y)
         {
-            TCoords p;
-            p.x = attrs[ci].ofsx;
-            p.y = attrs[ci].ofsy;
-            path.push_back(p);
-            ci -= W * p.y + p.x;
+            TCoords ofs = link_ofs(w.links[index2d(p.x, p.y)]);
+            path.push_back(ofs);
+            p.x -= ofs.x;
+            p.y -= ofs.y;
         }
     }
 
-    void get_path(TPath& path, const TCoords& start_p, const TCoords& finish_p) const
+    static void get_path(const Workspace& w, TPath& path, const TCoords& start_p, const TCoords& finish_p)
     {
-        get_path_ofs(path, start_p, finish_p);
+        get_path_ofs(w, path, start_p, finish_p);
         TCoords cp = start_p;
         for(auto& it : std::reverse(path.rbegin(), path.rend()))
         {
@@ -170,13 +483,26 @@ protected:
 
     static size_t index2d(size_t x, size_t y)
     {
-        return y * W + x;
+        return TLayout::template index<H, W>(x, y);
+    }
+
+    // Направление кодируется так же, как биты NeighbourBit: (dy + 1) * 3 + (dx + 1)
+    static unsigned char link_make(int dx, int dy)
+    {
+        return static_cast<unsigned char>((dy + 1) * 3 + (dx + 1));
+    }
+
+    static TCoords link_ofs(unsigned char l)
+    {
+        TCoords ofs;
+        ofs.x = l % 3 - 1;
+        ofs.y = l / 3 - 1;
+        return ofs;
     }
 
-    static TWeight cost_estimate(const TCoords& a, const TCoords& b)
+    TWeight cost_estimate(const TCoords& a, const TCoords& b) const
     {
-        TCoords dt; dt.x = b.x - a.x; dt.y = b.y - a.y;
-        return static_cast<TWeight>(10 * (dt.x * dt.x + dt.y * dt.y));
+        return static_cast<TWeight>(heuristic(a, b));
     }
 
     static bool inbound(int x, int y)
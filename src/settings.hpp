@@ -12,6 +12,19 @@ constexpr auto SCREEN_W = 1024;
 constexpr auto SCREEN_H = 768;
 constexpr auto WORLD_DIM = 30; // Размерность поля
 constexpr auto _LC_OFST = 8; // Желаемый отступ левого угла комнаты от края экрана
+constexpr auto HPA_MIN_DIM = 128; // Размерность поля, начиная с которой используется иерархический поиск пути
+constexpr auto HPA_CLUSTER = 16; // Размер кластера иерархического поиска пути
+constexpr auto HDA_MIN_DIM = 512; // Размерность поля, начиная с которой многопоточная сборка ищет путь точно, параллельным A*
+constexpr auto HDA_THREADS = 0u; // Потоков параллельного A*; 0 - по числу аппаратных
+constexpr auto PATH_CACHE_SIZE = 64; // Число запоминаемых путей
+constexpr auto PATH_SMOOTH = true; // Спрямлять найденные пути по прямой видимости
+constexpr auto PATH_SLICE_US = 2000; // Бюджет поиска пути на кадр в однопоточной сборке, мкс
+constexpr auto PATH_SLICE_STEPS = 64; // Раскрытий между проверками бюджета
+constexpr auto PATH_NEAREST_FALLBACK = true; // К недостижимой цели идти до ближайшей к ней достижимой клетки
+constexpr auto LANDMARK_COUNT = 8; // Число ориентиров для оценки расстояния
+constexpr auto WORKER_THREADS = 0u; // Потоков пула фоновых заданий; 0 - по числу аппаратных
+constexpr auto JOB_QUEUE_SIZE = 64; // Ёмкость очереди фоновых заданий
+constexpr auto PATH_SLOTS = 16; // Ячеек под одновременно обсчитываемые пути, степень двойки
 
 constexpr auto CELL_W = 2.0f / WORLD_DIM;
 constexpr auto CELL_HW = CELL_W / 2.0f;
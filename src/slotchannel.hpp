@@ -0,0 +1,145 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cassert>
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include "spscring.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Канал результатов из фоновых потоков в один поток-потребитель
+// Ячейки под результаты выделяются один раз. Потребитель берёт свободную
+// ячейку, заполняет в ней запрос и отдаёт её номер заданию; задание пишет
+// результат в ту же ячейку и возвращает номер через кольцо своего потока.
+// Владение ячейкой переходит вместе с номером, поэтому ни копий, ни выделений
+// памяти, ни блокировок при передаче нет. Кольцо у каждого производителя своё
+// и вмещает все ячейки, так что запись в него не отказывает.
+// Потребитель может опрашивать канал или ждать в wait_for(); производитель
+// будит его, лишь когда тот действительно ждёт.
+////////////////////////////////////////////////////////////////////////////////
+
+namespace tool
+{
+
+    template <
+        typename T, // Ячейка: запрос и результат
+        std::size_t N // Число ячеек, степень двойки
+    >
+    class SlotChannel
+    {
+        using Ring = SpscRing<unsigned, N>;
+
+        std::unique_ptr<T[]> slots;
+        std::vector<unsigned> idle; // Свободные ячейки. Только потребитель
+        std::vector<std::unique_ptr<Ring>> rings; // По одному на производителя
+        std::atomic<bool> sleeping; // Потребитель ждёт в wait_for()
+        std::mutex mtx;
+        std::condition_variable wakeup;
+
+    public:
+
+        explicit SlotChannel(std::size_t producers) : slots(new T[N]), sleeping(false)
+        {
+            idle.reserve(N);
+            for (unsigned i = N; i > 0; --i)
+                idle.push_back(i - 1);
+            for (std::size_t p = 0; p < producers; ++p)
+                rings.emplace_back(new Ring);
+        }
+        SlotChannel(const SlotChannel&) = delete;
+        SlotChannel& operator= (const SlotChannel&) = delete;
+
+        std::size_t producers_get() const { return rings.size(); }
+
+        // Доступ к ячейке её текущему владельцу
+        T& operator[](unsigned i) { return slots[i]; }
+
+        // Потребитель: свободная ячейка. false - все ячейки в работе
+        bool acquire(unsigned& i)
+        {
+            if (idle.empty())
+                return false;
+            i = idle.back();
+            idle.pop_back();
+            return true;
+        }
+
+        // Потребитель: возврат прочитанной ячейки
+        void release(unsigned i) { idle.push_back(i); }
+
+        // Производитель producer: передача заполненной ячейки потребителю.
+        // После вызова ячейка производителю больше не принадлежит
+        void publish(std::size_t producer, unsigned i)
+        {
+            bool pushed = rings[producer]->try_push(i);
+            assert(pushed);
+            (void)pushed;
+            // Запись номера и проверка ожидания не должны переставляться
+            // (парный барьер - в wait_for)
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (sleeping.load(std::memory_order_relaxed))
+            {
+                std::lock_guard<std::mutex> lck(mtx);
+                wakeup.notify_one();
+            }
+        }
+
+        // Потребитель: очередная заполненная ячейка. false - пока нет
+        bool take(unsigned& i)
+        {
+            for (auto& ring : rings)
+                if (ring->try_pop(i))
+                    return true;
+            return false;
+        }
+
+        // Потребитель: ожидание заполненной ячейки не дольше timeout.
+        // false - время истекло
+        template <typename Rep, typename Period>
+        bool wait_for(const std::chrono::duration<Rep, Period>& timeout)
+        {
+            std::unique_lock<std::mutex> lck(mtx);
+            sleeping.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool ready = wakeup.wait_for(lck, timeout, [this] { return !empty(); });
+            sleeping.store(false, std::memory_order_relaxed);
+            return ready;
+        }
+
+    private:
+
+        bool empty() const
+        {
+            for (auto& ring : rings)
+                if (!ring->empty())
+                    return false;
+            return true;
+        }
+    };
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright(c) 2017 https://github.com/mrprint
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
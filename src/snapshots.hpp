@@ -0,0 +1,113 @@
+﻿#pragma once
+
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////
+// Неизменяемые снимки объекта, изменяемого основным потоком
+// Снимок снимается лениво - при первом запросе после изменения объекта
+// (по его ревизии) - и живёт, пока им пользуется хоть одно фоновое задание.
+// Последний снимок публикуется атомарно и доступен любому потоку.
+// Буфер снимка, который больше никому не нужен, возвращается в запас и
+// переиспользуется следующим снимком: при одном-двух заданиях в работе
+// копирование идёт попеременно в одни и те же два буфера.
+////////////////////////////////////////////////////////////////////////////////
+
+namespace tool
+{
+
+    template <typename T> // Копируется присваиванием, предоставляет revision_get()
+    class Snapshots
+    {
+        // Запас освободившихся буферов. Разделяется с удалителями снимков,
+        // поэтому переживает хранилище, если снимки ещё в работе
+        struct Spare
+        {
+            std::mutex mtx;
+            std::vector<std::unique_ptr<T>> buffers;
+        };
+
+        std::shared_ptr<Spare> spare;
+#if defined(__cpp_lib_atomic_shared_ptr)
+        std::atomic<std::shared_ptr<const T>> current; // Последний опубликованный
+#else
+        std::shared_ptr<const T> current; // Последний опубликованный; только через std::atomic_load/store
+#endif
+
+    public:
+
+        Snapshots() : spare(std::make_shared<Spare>()) {}
+        Snapshots(const Snapshots&) = delete;
+        Snapshots& operator= (const Snapshots&) = delete;
+
+        // Снимок текущего состояния source. Только поток, изменяющий source
+        std::shared_ptr<const T> publish(const T& source)
+        {
+            auto last = latest();
+            if (last && last->revision_get() == source.revision_get())
+                return last;
+            std::unique_ptr<T> buffer;
+            {
+                // Захват блокировки упорядочивает запись в буфер после чтений
+                // снимка, который им был прежде
+                std::lock_guard<std::mutex> lck(spare->mtx);
+                if (!spare->buffers.empty())
+                {
+                    buffer = std::move(spare->buffers.back());
+                    spare->buffers.pop_back();
+                }
+            }
+            if (buffer)
+                *buffer = source;
+            else
+                buffer.reset(new T(source));
+            std::shared_ptr<Spare> home = spare;
+            std::shared_ptr<const T> snapshot(buffer.release(), [home](const T *p)
+            {
+                std::lock_guard<std::mutex> lck(home->mtx);
+                home->buffers.emplace_back(const_cast<T*>(p));
+            });
+#if defined(__cpp_lib_atomic_shared_ptr)
+            current.store(snapshot);
+#else
+            std::atomic_store(&current, snapshot);
+#endif
+            return snapshot;
+        }
+
+        // Последний опубликованный снимок или nullptr. Любой поток
+        std::shared_ptr<const T> latest() const
+        {
+#if defined(__cpp_lib_atomic_shared_ptr)
+            return current.load();
+#else
+            return std::atomic_load(&current);
+#endif
+        }
+    };
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright(c) 2017 https://github.com/mrprint
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
@@ -0,0 +1,96 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <atomic>
+
+////////////////////////////////////////////////////////////////////////////////
+// Кольцевая очередь одного писателя и одного читателя без блокировок
+// Писатель двигает только tail, читатель - только head; каждый из них держит
+// копию чужого индекса и перечитывает его лишь тогда, когда по копии очередь
+// кажется полной (пустой). Индексы разнесены по разным строкам кэша.
+////////////////////////////////////////////////////////////////////////////////
+
+namespace tool
+{
+
+    template <
+        typename T, // Элемент, копируемый присваиванием
+        std::size_t N // Ёмкость, степень двойки
+    >
+    class SpscRing
+    {
+        static_assert(N >= 2 && (N & (N - 1)) == 0, "Ring capacity must be a power of two");
+
+        static constexpr std::size_t LINE = 64; // Размер строки кэша
+
+        alignas(LINE) std::atomic<std::size_t> head; // Следующий для чтения
+        std::size_t tail_cache; // Копия tail у читателя
+        alignas(LINE) std::atomic<std::size_t> tail; // Следующий для записи
+        std::size_t head_cache; // Копия head у писателя
+        alignas(LINE) T items[N];
+
+    public:
+
+        SpscRing() : head(0), tail_cache(0), tail(0), head_cache(0) {}
+        SpscRing(const SpscRing&) = delete;
+        SpscRing& operator= (const SpscRing&) = delete;
+
+        // Только писатель. false - очередь полна
+        bool try_push(const T& item)
+        {
+            const std::size_t t = tail.load(std::memory_order_relaxed);
+            if (t - head_cache == N)
+            {
+                head_cache = head.load(std::memory_order_acquire);
+                if (t - head_cache == N)
+                    return false;
+            }
+            items[t & (N - 1)] = item;
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Только читатель. false - очередь пуста
+        bool try_pop(T& item)
+        {
+            const std::size_t h = head.load(std::memory_order_relaxed);
+            if (h == tail_cache)
+            {
+                tail_cache = tail.load(std::memory_order_acquire);
+                if (h == tail_cache)
+                    return false;
+            }
+            item = items[h & (N - 1)];
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Точно лишь при отсутствии конкурентных операций
+        bool empty() const
+        {
+            return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+        }
+    };
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright(c) 2017 https://github.com/mrprint
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
@@ -0,0 +1,102 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+// Пул рабочих пространств для параллельных поисков
+// Каждый вызывающий получает собственное пространство на время владения
+// арендой; по её окончании пространство возвращается в пул и переиспользуется.
+// Пространства создаются по требованию, их число ограничено лишь наибольшим
+// количеством одновременных аренд.
+////////////////////////////////////////////////////////////////////////////////
+
+namespace tool
+{
+
+    template <typename T>
+    class WorkspacePool
+    {
+        std::mutex mtx;
+        std::vector<std::unique_ptr<T>> idle;
+        std::size_t created;
+
+    public:
+
+        // Аренда пространства
+        class Lease
+        {
+            friend class WorkspacePool;
+
+            WorkspacePool *pool;
+            std::unique_ptr<T> ws;
+
+            Lease(WorkspacePool *_pool, std::unique_ptr<T>&& _ws) : pool(_pool), ws(std::move(_ws)) {}
+
+        public:
+
+            Lease(Lease&& r) noexcept : pool(r.pool), ws(std::move(r.ws)) {}
+            Lease(const Lease&) = delete;
+            Lease& operator= (const Lease&) = delete;
+            ~Lease() { if (ws) pool->release(std::move(ws)); }
+
+            T& operator* () const { return *ws; }
+            T* operator-> () const { return ws.get(); }
+        };
+
+        WorkspacePool() : created(0) {}
+
+        Lease acquire()
+        {
+            {
+                std::lock_guard<std::mutex> lck(mtx);
+                if (!idle.empty())
+                {
+                    std::unique_ptr<T> ws = std::move(idle.back());
+                    idle.pop_back();
+                    return Lease(this, std::move(ws));
+                }
+                ++created;
+            }
+            return Lease(this, std::unique_ptr<T>(new T)); // Выделение памяти - вне блокировки
+        }
+
+        std::size_t created_get()
+        {
+            std::lock_guard<std::mutex> lck(mtx);
+            return created;
+        }
+
+    private:
+
+        void release(std::unique_ptr<T>&& ws)
+        {
+            std::lock_guard<std::mutex> lck(mtx);
+            idle.push_back(std::move(ws));
+        }
+    };
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright(c) 2017 https://github.com/mrprint
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
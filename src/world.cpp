@@ -59,12 +59,46 @@ void Unit::move(tool::fpoint_fast tdelta)
     position += speed * tdelta;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void request_narrow(const Field& field, DeskPosition start, DeskPosition& finish, Goals& goals)
+{
+    if (goals.empty())
+    {
+        if (PATH_NEAREST_FALLBACK && field.unreachable(start, finish))
+            field.reachable_nearest(start, finish, finish);
+        return;
+    }
+    auto reachable_end = remove_if(goals.begin(), goals.end(),
+        [&field, start](const DeskPosition& g) { return field.unreachable(start, g); });
+    if (reachable_end != goals.begin() || !PATH_NEAREST_FALLBACK)
+    {
+        goals.erase(reachable_end, goals.end());
+        return;
+    }
+    // Ни одна цель не достижима - идём к клетке, ближайшей к какой-либо из них
+    int best = numeric_limits<int>::max();
+    for (auto& g : goals)
+    {
+        DeskPosition c;
+        if (!field.reachable_nearest(start, g, c))
+            return; // Старт занят - решит поиск
+        int cost = tool::HeuristicOctile()(c, g);
+        if (cost < best)
+        {
+            best = cost;
+            finish = c;
+        }
+    }
+    goals.clear();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 Character::Character() : Unit()
 {
     path_requested = false;
+    way_ticket = PathTicket{ 0, 0 };
     way.path.clear(); // Стоит на месте
-    way.target = 0;
+    way.target = way.start = 0;
 }
 
 void Character::move(tool::fpoint_fast tdelta)
@@ -72,27 +106,22 @@ void Character::move(tool::fpoint_fast tdelta)
     if (the_world.state == gsINPROGRESS)
         // Перемещаемся только во время игры
         Unit::move(tdelta);
-    if (way.path.size() == 0)
+    if (way.path.empty() || speed.atzero())
         return;
-    constexpr auto eps = numeric_limits<tool::fpoint_fast>::epsilon();
-    if ((speed.x > eps && position.x >= way.neigpos.x)
-        || (speed.x < -eps && position.x <= way.neigpos.x)
-        || (speed.y > eps && position.y >= way.neigpos.y)
-        || (speed.y < -eps && position.y <= way.neigpos.y))
+    // Отрезок пройден, когда его конечная точка оказалась позади
+    if ((way.neigpos - position).dot(speed) <= 0.0f)
     {
         // Этап завершен
         position = way.neigpos;
-        if (way.stage >= way.path.size() - 1)
+        if (++way.stage == way.path.end())
         {
             // Цель достигнута
             way.path.clear();
-            way.stage = 0;
             way.target = position;
         } else
         {
             // Следующий этап
-            ++way.stage;
-            way.neighbour += way.path[way.path.size() - way.stage - 1];
+            way.neighbour += *way.stage;
             way.neigpos = way.neighbour;
         }
         set_speed();
@@ -101,7 +130,7 @@ void Character::move(tool::fpoint_fast tdelta)
 
 void Character::set_speed()
 {
-    if (way.path.size() == 0)
+    if (way.path.empty())
     {
         speed = 0.0f;
         return;
@@ -115,23 +144,135 @@ void Character::set_speed()
     speed = d.normalized() * CHAR_B_SPEED;
 }
 
+#if defined(TOOL_COROUTINES)
+// Ожидание пути по запросу. К возобновлению юнит героя мог смениться вместе
+// с полем; ответ на чужой запрос отсеет way_new_process()
+static tool::Task way_await(PathTicket ticket)
+{
+    PathResult& result = co_await the_coworker.path_wait(ticket);
+    if (!result.cancelled)
+        the_world.character->way_new_process(result);
+}
+#endif
+
 // Запрос обсчета пути
 void Character::way_new_request(DeskPosition pos)
 {
-    speed = 0.0f;
+    way_cancel();
+    way_goals.clear();
+    way_stop();
     way.target = pos;
-    the_coworker.path_find_request(the_world.field, DeskPosition(position), pos);
-    path_requested = true;
+    way.revision = the_world.field.revision_get();
+    if (!PATH_NEAREST_FALLBACK && the_world.field.unreachable(way.start, pos))
+    {
+        // Цель отрезана стенами - поиск обошёл бы всю доступную область впустую
+        way_begin();
+        return;
+    }
+    if (the_world.paths.lookup(way.start, pos, way.revision, way.path))
+    {
+        // Путь уже известен - планировщик не нужен
+        way_begin();
+        return;
+    }
+    way_ticket = the_coworker.path_find(the_world.field_snapshot(), way.start, pos);
+    path_requested = way_ticket.id != 0; // Иначе расчёт занят - стоим до следующего запроса
+#if defined(TOOL_COROUTINES)
+    if (path_requested)
+        way_await(way_ticket);
+#endif
+}
+
+// Запрос обсчета пути к ближайшей из целей; цель станет известна по готовности пути
+void Character::way_new_request(const Goals& goals)
+{
+    way_cancel();
+    way_goals = goals;
+    way_stop();
+    way.target = way.start;
+    way.revision = the_world.field.revision_get();
+    way_ticket = the_coworker.path_find(the_world.field_snapshot(), way.start, goals);
+    path_requested = way_ticket.id != 0; // Иначе расчёт занят - стоим до следующего запроса
+#if defined(TOOL_COROUTINES)
+    if (path_requested)
+        way_await(way_ticket);
+#endif
+}
+
+// Путь к выходу по полю потока: направления уже готовы, поиск не нужен
+void Character::way_exit()
+{
+    way_cancel();
+    way_goals.clear();
+    way_stop();
+    way.revision = the_world.field.revision_get();
+    const FieldsFlowField& flow = the_world.exit_flow;
+    DeskPosition p = way.start, step;
+    Path ofs;
+    for (size_t n = 0; n < WORLD_DIM * WORLD_DIM && flow.step_get(p.x, p.y, step); ++n)
+    {
+        ofs.push_back(step);
+        p += step;
+    }
+    if (flow.distance_get(p.x, p.y) != 0)
+    {
+        // Выход отрезан - ищем путь к ближайшей к нему клетке
+        way_new_request(the_world.exits);
+        return;
+    }
+    reverse(ofs.begin(), ofs.end()); // Смещения пути хранятся от цели к старту
+    if (PATH_SMOOTH)
+        tool::path_smooth(ofs, the_world.field, way.start);
+    way.target = p;
+    way.path.assign_ofs(ofs);
+    way_begin();
+}
+
+void Character::way_renew()
+{
+    if (!way_goals.empty())
+    {
+        Goals goals;
+        goals.swap(way_goals); // way_new_request() заполнит заново
+        way_new_request(goals);
+    } else
+        way_new_request(way.target);
 }
 
 // Обработка рассчитанного пути
-void Character::way_new_process()
+void Character::way_new_process(PathResult& result)
+{
+    if (!path_requested || result.id != way_ticket.id)
+        return; // Ответ на устаревший запрос
+    path_requested = false;
+    way.path.swap(result.path); // Прежний буфер пути уходит в ячейку канала
+    way.target = result.goal; // Для нескольких целей - достигнутая
+    if (way.target.x != way.start.x || way.target.y != way.start.y)
+        the_world.paths.store(way.start, way.target, way.revision, way.path);
+    way_begin();
+}
+
+void Character::way_cancel()
+{
+    if (path_requested)
+        the_coworker.path_cancel(way_ticket);
+    path_requested = false;
+}
+
+void Character::way_stop()
+{
+    way.path.clear();
+    way.start = DeskPosition(position);
+    speed = 0.0f;
+}
+
+void Character::way_begin()
 {
-    the_coworker.path_read(way.path);
-    if (way.path.size() > 0)
+    if (!way.path.empty())
     {
-        way.stage = 0;
-        way.neighbour = static_cast<DeskPosition>(position) + way.path[way.path.size() - 1];
+        // Путь рассчитан от клетки запроса, где герой и стоит с тех пор
+        way.stage = way.path.begin();
+        way.neighbour = way.start + *way.stage;
         way.neigpos = way.neighbour;
     }
     set_speed();
@@ -162,10 +303,11 @@ void World::setup()
     lists_clear();
 
     // Размечаем поле
-    for (int y = 0; y < WORLD_DIM; y++)
-        for (int x = 0; x < WORLD_DIM; x++)
-            field(x, y).attribs.reset();
+    field.clear();
+    the_coworker.field_reset(field.revision_get());
     field(WORLD_DIM - 1, 0).attribs.set(Cell::atrEXIT); // Позиция выхода
+    exits.assign(1, DeskPosition(WORLD_DIM - 1, 0));
+    exit_flow.build(field, DeskPosition(WORLD_DIM - 1, 0));
     field(0, 2).attribs.set(Cell::atrGUARDFORW); // Вешка направления движения охраны
     field(WORLD_DIM - 1, 2).attribs.set(Cell::atrGUARDBACKW); // Вешка направления движения охраны
     // Главный герой
@@ -4,10 +4,28 @@
 #include <bitset>
 #include <vector>
 #include <array>
+#include <future>
+#include <atomic>
+#include <memory>
 #include <algorithm>
+#include <type_traits>
 #include "settings.hpp"
 #include "hfstorage.hpp"
+#include "bitboard.hpp"
+#include "components.hpp"
+#include "packedpath.hpp"
+#include "pathcache.hpp"
+#include "snapshots.hpp"
+#include "slotchannel.hpp"
+#include "coroutines.hpp"
+#include "landmarks.hpp"
 #include "pathfinding.hpp"
+#include "jps.hpp"
+#include "dstarlite.hpp"
+#include "hpastar.hpp"
+#include "hdastar.hpp"
+#include "flowfield.hpp"
+#include "anyangle.hpp"
 #include "spaces.hpp"
 #include "mathapp.hpp"
 
@@ -54,21 +72,129 @@ public:
 
 ////////////////////////////////////////////////////////////////////////////////
 // Игровое поле
+// Признак препятствия дублируется в плотной битовой карте, которую читают
+// алгоритмы поиска пути, поэтому менять его следует только через obstacle_set()
 class Field
 {
     Cell cells[WORLD_DIM][WORLD_DIM];
+    tool::Bitboard<WORLD_DIM, WORLD_DIM> obstacles;
+    tool::Components<WORLD_DIM, WORLD_DIM> components; // Связные области свободных клеток
+    unsigned long revision; // Растёт при каждом изменении препятствий
 
 public:
 
-    Field() = default;
+    Field() : revision(0) {}
     Cell& operator[](tool::DeskPosition i) { return cells[i.y][i.x]; }
     Cell& operator()(unsigned x, unsigned y) { return cells[y][x]; }
-    // Интерфейсный метод для AStar
-    bool isobstacle(int x, int y) const { return cells[y][x].attribs.test(Cell::atrOBSTACLE); }
+    // Сброс атрибутов всех клеток
+    void clear()
+    {
+        for (auto& row : cells)
+            for (auto& cell : row)
+                cell.attribs.reset();
+        obstacles.clear();
+        components.reset();
+        ++revision;
+    }
+    void obstacle_set(tool::DeskPosition i, bool value)
+    {
+        cells[i.y][i.x].attribs.set(Cell::atrOBSTACLE, value);
+        obstacles.set(i.x, i.y, value);
+        components.cell_changed(*this, i.x, i.y);
+        ++revision;
+    }
+    unsigned long revision_get() const { return revision; }
+    // Цель заведомо недостижима из стартовой клетки, искать путь незачем
+    bool unreachable(tool::DeskPosition from, tool::DeskPosition to) const
+    {
+        return components.separated(from.x, from.y, to.x, to.y);
+    }
+    // Ближайшая к цели клетка, достижимая из стартовой. false - стартовая занята
+    bool reachable_nearest(tool::DeskPosition from, tool::DeskPosition to, tool::DeskPosition& found) const
+    {
+        return components.nearest_in_area(from.x, from.y, to.x, to.y, found);
+    }
+    // Интерфейсные методы для AStar
+    bool isobstacle(int x, int y) const { return obstacles.test(x, y); }
+    unsigned obstacles_around(int x, int y) const { return obstacles.neighbours(x, y); }
 };
 
+using FieldSnapshot = std::shared_ptr<const Field>; // Неизменяемая версия поля для фоновых заданий
 using Path = std::vector<tool::DeskPosition>; // Оптимальный путь между ячейками
-using FieldsAStar = AStar<WORLD_DIM, WORLD_DIM, tool::DeskPosition, Field>; // AStar, подогнанный к Field
+using CompactPath = tool::PackedPath<tool::DeskPosition>; // Тот же путь в сжатом виде, в порядке движения
+using Goals = std::vector<tool::DeskPosition>; // Цели многоцелевого поиска
+// Сужение запроса по разметке областей, до поиска: недостижимые цели
+// отбрасываются. Если не остаётся ни одной, а PATH_NEAREST_FALLBACK, целью
+// становится ближайшая к ним достижимая клетка (goals очищается), так что
+// искать её волной по всей области не нужно
+void request_narrow(const Field&, tool::DeskPosition start, tool::DeskPosition& finish, Goals& goals);
+// Рассчитанный путь и цель, к которой он ведёт: запрошенная или достигнутая из нескольких.
+// Если ни одна из нескольких целей не достижима - стартовая клетка
+struct PathResult
+{
+    CompactPath path;
+    tool::DeskPosition goal;
+    unsigned long id; // Номер запроса, на который это ответ
+    bool cancelled; // Расчёт прерван: путь неполон и отдаваться не должен
+};
+// Запрос пути: номер и ячейка канала, в которой он обсчитывается.
+// Новый запрос того же персонажа отменяет прежний, и задание, ещё стоящее
+// в очереди или уже ищущее путь, завершается, не досчитав его
+struct PathTicket
+{
+    unsigned long id; // 0 - запроса не было
+    unsigned slot;
+};
+// Ячейка канала путей: запрос, флаг его отмены и место под результат.
+// Буферы ячейки переиспользуются от запроса к запросу
+struct PathSlot
+{
+    FieldSnapshot field;
+    tool::DeskPosition start_p, finish_p;
+    Goals goals; // Цели многоцелевого запроса; пусто - единственная finish_p
+    std::atomic<bool> cancel;
+    PathResult result; // Номер запроса пишет только потребитель
+#if defined(TOOL_COROUTINES)
+    std::coroutine_handle<> waiter; // Ожидающая результат сопрограмма. Только потребитель
+#endif
+};
+#if defined(TOOL_COROUTINES)
+// co_await - ожидание результата запроса в сопрограмме. Она возобновляется
+// в results_take(), в том числе и после отмены (result.cancelled). Ссылка на
+// результат действительна до следующей приостановки сопрограммы
+struct PathAwait
+{
+    PathSlot& slot;
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h) noexcept { slot.waiter = h; }
+    PathResult& await_resume() const noexcept { return slot.result; }
+};
+#endif
+// Ждёт ли результат ячейки сопрограмма
+inline bool slot_awaited(const PathSlot &slot)
+{
+#if defined(TOOL_COROUTINES)
+    return static_cast<bool>(slot.waiter);
+#else
+    (void)slot;
+    return false;
+#endif
+}
+using PathChannel = tool::SlotChannel<PathSlot, PATH_SLOTS>; // Передача путей основному потоку
+using FieldsLandmarks = tool::LandmarkTable<WORLD_DIM, WORLD_DIM, tool::DeskPosition, Field, LANDMARK_COUNT>; // Ориентиры по Field
+using FieldsHeuristic = tool::HeuristicLandmarks<FieldsLandmarks>;
+// AStar, подогнанный к Field. Октильная оценка, уточняемая по ориентирам, если их таблица
+// построена для текущей ревизии поля
+using FieldsAStar = AStar<WORLD_DIM, WORLD_DIM, tool::DeskPosition, Field, int, Path,
+    tool::IndexedOpenList, FieldsHeuristic>;
+using FieldsJPS = JPSearch<WORLD_DIM, WORLD_DIM, tool::DeskPosition, Field>; // Jump Point Search, подогнанный к Field
+using FieldsDStarLite = DStarLite<WORLD_DIM, WORLD_DIM, tool::DeskPosition, Field>; // D* Lite, подогнанный к Field
+using FieldsHPAStar = HPAStar<WORLD_DIM, WORLD_DIM, tool::DeskPosition, Field, HPA_CLUSTER>; // HPA*, подогнанный к Field
+using FieldsHDAStar = HDAStar<WORLD_DIM, WORLD_DIM, tool::DeskPosition, Field, int, Path>; // Параллельный A*, подогнанный к Field
+// Планировщик рабочего потока: на больших полях - иерархический
+using FieldsPlanner = std::conditional_t<(WORLD_DIM >= HPA_MIN_DIM), FieldsHPAStar, FieldsDStarLite>;
+using FieldsFlowField = FlowField<WORLD_DIM, WORLD_DIM, tool::DeskPosition, Field>; // Поле потока, подогнанное к Field
+using FieldsPathCache = tool::PathCache<WORLD_DIM, WORLD_DIM, tool::DeskPosition, CompactPath>; // Кэш путей по Field
 
 ////////////////////////////////////////////////////////////////////////////////
 // Базовый класс игровых юнитов
@@ -107,13 +233,17 @@ public:
     // Характеристики пути к цели
     struct Target {
         tool::DeskPosition neighbour, target; // Ближайшая ячейка на пути и целевая
+        tool::DeskPosition start; // Ячейка, от которой запрошен путь
         tool::SpacePosition neigpos; // Пространственные координаты центра ближайшей ячейки
-        Path path; // Список директив смены направления
-        unsigned stage; // Этап на пути
+        CompactPath path; // Отрезки пути
+        CompactPath::const_iterator stage; // Текущий отрезок
+        unsigned long revision; // Ревизия поля, для которой запрошен путь
     };
 
     Target way; // Набор характеристик пути к цели
+    Goals way_goals; // Цели последнего многоцелевого запроса; пусто - запрошена way.target
     bool path_requested; // Обсчитывается путь
+    PathTicket way_ticket; // Последний запрос пути; прежние отменены
 
     Character();
     virtual Type id() const override { return utCharacter; }
@@ -122,8 +252,24 @@ public:
     void set_speed();
     // Запрос обсчета пути
     void way_new_request(tool::DeskPosition);
-    // Обработка рассчитанного пути
-    void way_new_process();
+    // Запрос обсчета пути к ближайшей из нескольких целей
+    void way_new_request(const Goals&);
+    // Путь к выходу по полю потока exit_flow
+    void way_exit();
+    // Повтор последнего запроса по изменившемуся полю
+    void way_renew();
+    // Обработка рассчитанного пути. Путь забирается из результата обменом
+    void way_new_process(PathResult&);
+
+private:
+
+    // Отмена обсчитываемого пути
+    void way_cancel();
+
+    // Остановка до получения нового пути
+    void way_stop();
+    // Начало движения по полученному пути
+    void way_begin();
 };
 
 // Стражник
@@ -174,21 +320,32 @@ class World
 public:
     unsigned level; // Текущий уровень, начиная с 0
     GameState state; // Этап игры
-    Field field; // Игровое поле
+    Field field; // Игровое поле. Меняется только основным потоком
+    tool::Snapshots<Field> field_versions; // Снимки поля для фоновых заданий
     UnitsList alives; // Активные объекты
     Artillery artillery; // Все пушки
     Character *character; // Указатель на юнит главного героя, содержащийся в общем списке
     SoundsQueue sounds; // Очередь звуков
+    FieldsPathCache paths; // Недавно найденные пути
+    FieldsFlowField exit_flow; // Направления к выходу для любого числа агентов
+    Goals exits; // Клетки выхода (с атрибутом atrEXIT)
 
     World() :
         level(0),
         state(gsINPROGRESS),
         field(),
+        field_versions(),
         alives(*std::max_element(all_unit_sizes.begin(), all_unit_sizes.end()), WORLD_DIM * WORLD_DIM / 2),
         artillery(),
         character(),
-        sounds()
+        sounds(),
+        paths(PATH_CACHE_SIZE),
+        exit_flow(),
+        exits()
     { }
+    // Снимок поля в текущей ревизии. Ревизия растёт лишь со сменой препятствий,
+    // прочие атрибуты клеток в снимке могут отставать
+    FieldSnapshot field_snapshot() { return field_versions.publish(field); }
     void move_do(tool::fpoint_fast);
     void setup();
     void state_check();
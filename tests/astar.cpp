@@ -0,0 +1,95 @@
+﻿#include <memory>
+#include "testing.hpp"
+#include "pathfinding.hpp"
+
+using namespace testing;
+
+// Сверка длины найденных путей с эталоном на картах возрастающей плотности.
+// Допустимая оценка обязана давать кратчайший путь при любом открытом списке
+template <template <typename> class TOpened, typename THeuristic>
+static void against_dijkstra()
+{
+    constexpr std::size_t N = 48;
+    using Planner = AStar<N, N, Coords, Map<N>, int, std::vector<Coords>, TOpened, THeuristic>;
+    std::unique_ptr<Planner> astar(new Planner);
+    std::mt19937 rnd(1);
+    for (int round = 0; round < 16; ++round)
+    {
+        Map<N> map;
+        map.scatter(rnd, 0.1 + 0.025 * round);
+        const Coords start = map.free_cell(rnd);
+        const auto dist = distances(map, start);
+        for (int query = 0; query < 8; ++query)
+        {
+            const Coords finish = map.any_cell(rnd);
+            std::vector<Coords> path;
+            const bool found = astar->search_ofs(path, map, start, finish);
+            CHECK(found == (distance<N>(dist, finish) >= 0));
+            if (!found)
+                continue;
+            Coords end;
+            CHECK(walk(map, start, path, end) == distance<N>(dist, finish));
+            CHECK(end == finish);
+        }
+    }
+}
+
+TEST_CASE(astar, queue_octile) { against_dijkstra<tool::QueueOpenList, tool::HeuristicOctile>(); }
+TEST_CASE(astar, queue_zero) { against_dijkstra<tool::QueueOpenList, tool::HeuristicZero>(); }
+TEST_CASE(astar, indexed_octile) { against_dijkstra<tool::IndexedOpenList, tool::HeuristicOctile>(); }
+TEST_CASE(astar, indexed_zero) { against_dijkstra<tool::IndexedOpenList, tool::HeuristicZero>(); }
+
+// Двунаправленный поиск с согласованной оценкой находит пути той же длины,
+// что и односторонний, в том числе без срезания углов
+template <typename TNeighbourhood>
+static void bidir_against_unidir()
+{
+    constexpr std::size_t N = 48;
+    using Planner = AStar<N, N, Coords, Map<N>, int, std::vector<Coords>, tool::IndexedOpenList, tool::HeuristicOctile,
+        TNeighbourhood>;
+    std::unique_ptr<Planner> astar(new Planner);
+    std::mt19937 rnd(10);
+    for (int round = 0; round < 16; ++round)
+    {
+        Map<N> map;
+        map.scatter(rnd, 0.1 + 0.025 * round);
+        for (int query = 0; query < 8; ++query)
+        {
+            const Coords start = map.free_cell(rnd), finish = map.any_cell(rnd);
+            std::vector<Coords> one, both;
+            const bool found = astar->search_ofs(one, map, start, finish);
+            CHECK(astar->search_bidir_ofs(both, map, start, finish) == found);
+            if (!found)
+                continue;
+            Coords end;
+            const int cost = walk(map, start, one, end);
+            CHECK(cost >= 0);
+            CHECK(walk(map, start, both, end) == cost);
+            CHECK(end == finish);
+        }
+    }
+}
+
+TEST_CASE(astar, bidir_eight) { bidir_against_unidir<tool::NeighbourhoodEight>(); }
+TEST_CASE(astar, bidir_eight_nocut) { bidir_against_unidir<tool::NeighbourhoodEightNoCut>(); }
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright(c) 2017 https://github.com/mrprint
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
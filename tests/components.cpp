@@ -0,0 +1,118 @@
+﻿#include <memory>
+#include <map>
+#include "testing.hpp"
+#include "components.hpp"
+
+using namespace testing;
+
+namespace
+{
+
+    constexpr std::size_t N = 48;
+
+    // Эталонная разметка обходом в ширину при 8-связности со срезанием углов
+    std::vector<unsigned> labels_bfs(const Map<N>& map)
+    {
+        std::vector<unsigned> labels(N * N, 0);
+        std::vector<std::size_t> front;
+        unsigned count = 0;
+        for (std::size_t s = 0; s < N * N; ++s)
+        {
+            if (map.cells[s] || labels[s])
+                continue;
+            labels[s] = ++count;
+            front.assign(1, s);
+            for (std::size_t head = 0; head < front.size(); ++head)
+            {
+                const int x = static_cast<int>(front[head] % N), y = static_cast<int>(front[head] / N);
+                for (int dy = -1; dy <= 1; ++dy)
+                    for (int dx = -1; dx <= 1; ++dx)
+                    {
+                        const int nx = x + dx, ny = y + dy;
+                        if (nx < 0 || ny < 0 || nx >= static_cast<int>(N) || ny >= static_cast<int>(N))
+                            continue;
+                        const std::size_t ni = ny * N + nx;
+                        if (map.cells[ni] || labels[ni])
+                            continue;
+                        labels[ni] = count;
+                        front.push_back(ni);
+                    }
+            }
+        }
+        return labels;
+    }
+
+    // Разметки совпадают с точностью до переименования меток
+    bool same_partition(const Map<N>& map, const tool::Components<N, N>& comps)
+    {
+        const auto expected = labels_bfs(map);
+        std::map<unsigned, unsigned> forward, backward;
+        for (std::size_t i = 0; i < N * N; ++i)
+        {
+            const unsigned l = comps.label_get(static_cast<int>(i % N), static_cast<int>(i / N));
+            if (map.cells[i])
+            {
+                if (l != 0)
+                    return false;
+                continue;
+            }
+            if (l == 0)
+                return false;
+            auto f = forward.emplace(expected[i], l);
+            auto b = backward.emplace(l, expected[i]);
+            if (f.first->second != l || b.first->second != expected[i])
+                return false;
+        }
+        return true;
+    }
+
+}
+
+// Случайные одиночные клетки и сплошные стены, разрезающие поле на части
+TEST_CASE(components, random_flips)
+{
+    Map<N> map;
+    std::unique_ptr<tool::Components<N, N>> comps(new tool::Components<N, N>);
+    std::mt19937 rnd(5);
+    for (int flip = 0; flip < 4000; ++flip)
+    {
+        Coords c = map.any_cell(rnd);
+        if (flip > 1500 && flip % 3 == 0)
+            c.y = static_cast<int>(rnd() % 4) * static_cast<int>(N / 4);
+        map.flip(c.x, c.y);
+        comps->cell_changed(map, c.x, c.y);
+        if (flip % 50 == 0)
+            CHECK(same_partition(map, *comps));
+    }
+    CHECK(same_partition(map, *comps));
+
+    for (int query = 0; query < 200; ++query)
+    {
+        const Coords a = map.any_cell(rnd), b = map.any_cell(rnd);
+        if (map.isobstacle(a.x, a.y) || map.isobstacle(b.x, b.y))
+            continue;
+        const bool expected = distance<N>(distances(map, a), b) < 0;
+        CHECK(comps->separated(a.x, a.y, b.x, b.y) == expected);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright(c) 2017 https://github.com/mrprint
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
@@ -0,0 +1,147 @@
+﻿#include <memory>
+#include "testing.hpp"
+#include "dstarlite.hpp"
+#include "hpastar.hpp"
+#include "hdastar.hpp"
+
+using namespace testing;
+
+namespace
+{
+
+    constexpr std::size_t N = 48;
+
+    // Смена проходимости нескольких случайных клеток, кроме перечисленных
+    template <typename F>
+    void flip_some(Map<N>& map, std::mt19937& rnd, const Coords& keep0, const Coords& keep1, F&& changed)
+    {
+        for (int k = 1 + static_cast<int>(rnd() % 4); k > 0; --k)
+        {
+            const Coords c = map.any_cell(rnd);
+            if (c == keep0 || c == keep1)
+                continue;
+            map.flip(c.x, c.y);
+            changed(c.x, c.y);
+        }
+    }
+
+}
+
+// Персонаж идёт по найденному пути, карта меняется под ним; каждый
+// повторный поиск должен давать кратчайший путь по текущей карте
+TEST_CASE(dstarlite, random_flips)
+{
+    using Planner = DStarLite<N, N, Coords, Map<N>>;
+    std::unique_ptr<Planner> dstar(new Planner);
+    std::mt19937 rnd(2);
+    for (int round = 0; round < 12; ++round)
+    {
+        Map<N> map;
+        map.scatter(rnd, 0.2 + 0.01 * round);
+        Coords start = map.free_cell(rnd);
+        const Coords finish = map.free_cell(rnd);
+        dstar->reset();
+        for (int step = 0; step < 30; ++step)
+        {
+            std::vector<Coords> path;
+            const bool found = dstar->search_ofs(path, map, start, finish);
+            const int expected = distance<N>(distances(map, finish), start);
+            CHECK(found == (expected >= 0));
+            if (found)
+            {
+                Coords end;
+                CHECK(walk(map, start, path, end) == expected);
+                CHECK(end == finish);
+                for (int m = 0; m < 2 && !path.empty(); ++m)
+                {
+                    start.x += path.back().x;
+                    start.y += path.back().y;
+                    path.pop_back();
+                }
+            }
+            flip_some(map, rnd, start, finish, [&](int x, int y) { dstar->cell_changed(x, y); });
+        }
+    }
+}
+
+// Путь по абстрактному графу не обязан быть кратчайшим, но должен быть
+// проходим и находиться всякий раз, когда цель достижима
+TEST_CASE(hpastar, random_flips)
+{
+    using Planner = HPAStar<N, N, Coords, Map<N>, 8>;
+    std::unique_ptr<Planner> hpa(new Planner);
+    std::mt19937 rnd(3);
+    for (int round = 0; round < 8; ++round)
+    {
+        Map<N> map;
+        map.scatter(rnd, 0.15 + 0.02 * round);
+        hpa->reset();
+        for (int step = 0; step < 30; ++step)
+        {
+            const Coords start = map.free_cell(rnd), finish = map.free_cell(rnd);
+            hpa->cell_changed(start.x, start.y);
+            hpa->cell_changed(finish.x, finish.y);
+            std::vector<Coords> path;
+            const bool found = hpa->search_ofs(path, map, start, finish);
+            const int expected = distance<N>(distances(map, start), finish);
+            CHECK(found == (expected >= 0));
+            if (found)
+            {
+                Coords end;
+                CHECK(walk(map, start, path, end) >= expected);
+                CHECK(end == finish);
+            }
+            flip_some(map, rnd, start, finish, [&](int x, int y) { hpa->cell_changed(x, y); });
+        }
+    }
+}
+
+// Распределённый поиск обязан совпадать с эталоном при любом числе потоков
+static void hdastar_flips(unsigned threads)
+{
+    using Planner = HDAStar<N, N, Coords, Map<N>>;
+    std::unique_ptr<Planner> hda(new Planner(threads));
+    std::mt19937 rnd(4 + threads);
+    Map<N> map;
+    map.scatter(rnd, 0.25);
+    for (int step = 0; step < 60; ++step)
+    {
+        const Coords start = map.free_cell(rnd), finish = map.any_cell(rnd);
+        std::vector<Coords> path;
+        const bool found = hda->search_ofs(path, map, start, finish);
+        const int expected = distance<N>(distances(map, start), finish);
+        CHECK(found == (expected >= 0));
+        if (found)
+        {
+            Coords end;
+            CHECK(walk(map, start, path, end) == expected);
+            CHECK(end == finish);
+        }
+        flip_some(map, rnd, start, start, [](int, int) {});
+    }
+}
+
+TEST_CASE(hdastar, one_thread) { hdastar_flips(1); }
+TEST_CASE(hdastar, two_threads) { hdastar_flips(2); }
+TEST_CASE(hdastar, four_threads) { hdastar_flips(4); }
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright(c) 2017 https://github.com/mrprint
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
@@ -0,0 +1,73 @@
+﻿#include <memory>
+#include <limits>
+#include "testing.hpp"
+#include "flowfield.hpp"
+
+using namespace testing;
+
+// После каждой смены клетки поле, обновлённое частично, совпадает с
+// построенным заново, а шаг из каждой клетки ведёт вниз по расстоянию
+TEST_CASE(flowfield, incremental_matches_rebuild)
+{
+    constexpr std::size_t N = 40;
+    using Field = FlowField<N, N, Coords, Map<N>>;
+    std::unique_ptr<Field> field(new Field), rebuilt(new Field);
+    std::mt19937 rnd(6);
+    Map<N> map;
+    map.scatter(rnd, 0.25);
+    const Coords goal = map.free_cell(rnd);
+    field->build(map, goal);
+    for (int flip = 0; flip < 600; ++flip)
+    {
+        const Coords c = map.any_cell(rnd);
+        if (c == goal)
+            continue;
+        map.flip(c.x, c.y);
+        field->cell_changed(map, c.x, c.y);
+        if (flip % 20 != 0)
+            continue;
+        rebuilt->build(map, goal);
+        const auto dist = distances(map, goal);
+        int mismatches = 0;
+        for (int y = 0; y < static_cast<int>(N); ++y)
+            for (int x = 0; x < static_cast<int>(N); ++x)
+            {
+                const int d = field->distance_get(x, y);
+                if (d != rebuilt->distance_get(x, y))
+                    ++mismatches;
+                if (!map.isobstacle(x, y)
+                    && d != (distance<N>(dist, Coords{ x, y }) < 0 ? std::numeric_limits<int>::max() : distance<N>(dist, Coords{ x, y })))
+                    ++mismatches;
+                Coords ofs;
+                if (field->step_get(x, y, ofs))
+                {
+                    const int nx = x + ofs.x, ny = y + ofs.y;
+                    const int step = ofs.x != 0 && ofs.y != 0 ? tool::GRID_DIAG_COST : tool::GRID_STEP_COST;
+                    if (map.isobstacle(nx, ny) || field->distance_get(nx, ny) + step != d)
+                        ++mismatches;
+                }
+            }
+        CHECK(mismatches == 0);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright(c) 2017 https://github.com/mrprint
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
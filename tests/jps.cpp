@@ -0,0 +1,80 @@
+﻿#include <memory>
+#include "testing.hpp"
+#include "jps.hpp"
+
+using namespace testing;
+
+namespace
+{
+
+    constexpr std::size_t N = 48;
+
+    // Открытое поле со стенами-отрезками: длинные прямые и углы
+    // порождают вынужденных соседей чаще случайного шума
+    void walls(Map<N>& map, std::mt19937& rnd)
+    {
+        for (int k = 0; k < static_cast<int>(N / 3); ++k)
+        {
+            const Coords c = map.any_cell(rnd);
+            const bool horizontal = rnd() % 2 != 0;
+            for (int i = static_cast<int>(N / 8 + rnd() % (N / 3)); i >= 0; --i)
+            {
+                const int x = horizontal ? c.x + i : c.x, y = horizontal ? c.y : c.y + i;
+                if (x < static_cast<int>(N) && y < static_cast<int>(N))
+                    map.set(x, y, true);
+            }
+        }
+    }
+
+}
+
+// Точки прыжка не должны терять кратчайших путей ни на шуме, ни на стенах
+TEST_CASE(jps, against_dijkstra)
+{
+    using Planner = JPSearch<N, N, Coords, Map<N>>;
+    std::unique_ptr<Planner> jps(new Planner);
+    std::mt19937 rnd(9);
+    for (int round = 0; round < 24; ++round)
+    {
+        Map<N> map;
+        if (round % 2 == 0)
+            map.scatter(rnd, 0.1 + 0.02 * round);
+        else
+            walls(map, rnd);
+        const Coords start = map.free_cell(rnd);
+        const auto dist = distances(map, start);
+        for (int query = 0; query < 8; ++query)
+        {
+            const Coords finish = map.any_cell(rnd);
+            std::vector<Coords> path;
+            const bool found = jps->search_ofs(path, map, start, finish);
+            CHECK(found == (distance<N>(dist, finish) >= 0));
+            if (!found)
+                continue;
+            Coords end;
+            CHECK(walk(map, start, path, end) == distance<N>(dist, finish));
+            CHECK(end == finish);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright(c) 2017 https://github.com/mrprint
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
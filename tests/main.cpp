@@ -0,0 +1,67 @@
+﻿#include <cstdio>
+#include <cstring>
+#include "testing.hpp"
+
+namespace testing
+{
+
+    static int failures = 0;
+
+    std::vector<Case>& cases()
+    {
+        static std::vector<Case> all;
+        return all;
+    }
+
+    void failure(const char *file, int line, const char *expr)
+    {
+        ++failures;
+        std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", file, line, expr);
+    }
+
+}
+
+// Аргументы - имена групп; без них выполняются все проверки
+int main(int argc, char *argv[])
+{
+    int ran = 0;
+    for (auto& c : testing::cases())
+    {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc && !selected; ++i)
+            selected = std::strcmp(argv[i], c.group) == 0;
+        if (!selected)
+            continue;
+        const int before = testing::failures;
+        c.body();
+        ++ran;
+        std::printf("%s %s.%s\n", testing::failures == before ? "ok  " : "FAIL", c.group, c.name);
+    }
+    if (ran == 0)
+    {
+        std::fprintf(stderr, "No tests selected\n");
+        return 1;
+    }
+    return testing::failures == 0 ? 0 : 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright(c) 2017 https://github.com/mrprint
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
@@ -0,0 +1,107 @@
+﻿#include <cstdlib>
+#include "testing.hpp"
+#include "packedpath.hpp"
+
+using namespace testing;
+
+namespace
+{
+
+    // Смещения по восьми направлениям раскладываются на единичные шаги,
+    // прочие остаются как есть: так сравнимы пути до и после слияния отрезков
+    void unit_steps_append(std::vector<Coords>& steps, const Coords& ofs)
+    {
+        const int ax = std::abs(ofs.x), ay = std::abs(ofs.y);
+        if (ax != 0 && ay != 0 && ax != ay)
+        {
+            steps.push_back(ofs);
+            return;
+        }
+        const int run = ax > ay ? ax : ay;
+        for (int i = 0; i < run; ++i)
+            steps.push_back(Coords{ ofs.x / run, ofs.y / run });
+    }
+
+    std::vector<Coords> unpack(const tool::PackedPath<Coords>& packed)
+    {
+        std::vector<Coords> steps;
+        for (const Coords& ofs : packed)
+            unit_steps_append(steps, ofs);
+        return steps;
+    }
+
+}
+
+// Путь из единичных шагов с длинными прямыми участками в формате AStar
+TEST_CASE(packedpath, unit_steps_round_trip)
+{
+    std::mt19937 rnd(7);
+    for (int round = 0; round < 100; ++round)
+    {
+        std::vector<Coords> reversed;
+        for (int run = static_cast<int>(rnd() % 20); run > 0; --run)
+        {
+            Coords dir{ static_cast<int>(rnd() % 3) - 1, static_cast<int>(rnd() % 3) - 1 };
+            if (dir.x == 0 && dir.y == 0)
+                dir.x = 1;
+            for (int len = 1 + static_cast<int>(rnd() % 70); len > 0; --len)
+                reversed.push_back(dir);
+        }
+        tool::PackedPath<Coords> packed;
+        packed.assign_ofs(reversed);
+        const std::vector<Coords> forward(reversed.rbegin(), reversed.rend());
+        CHECK(unpack(packed) == forward);
+        CHECK(packed.empty() == reversed.empty());
+        CHECK(packed.size_bytes() <= reversed.size());
+    }
+}
+
+// Спрямлённый путь: отрезки под произвольными углами вперемешку с прямыми
+TEST_CASE(packedpath, arbitrary_offsets_round_trip)
+{
+    std::mt19937 rnd(8);
+    for (int round = 0; round < 100; ++round)
+    {
+        tool::PackedPath<Coords> packed;
+        std::vector<Coords> expected;
+        for (int segment = static_cast<int>(rnd() % 40); segment > 0; --segment)
+        {
+            Coords ofs;
+            if (rnd() % 2)
+            {
+                const int len = 1 + static_cast<int>(rnd() % 100);
+                ofs = Coords{ (static_cast<int>(rnd() % 3) - 1) * len, (static_cast<int>(rnd() % 3) - 1) * len };
+            } else
+            {
+                ofs = Coords{ static_cast<int>(rnd() % 4001) - 2000, static_cast<int>(rnd() % 4001) - 2000 };
+            }
+            packed.push_back(ofs.x, ofs.y);
+            unit_steps_append(expected, ofs);
+        }
+        CHECK(unpack(packed) == expected);
+        packed.clear();
+        CHECK(packed.empty());
+        CHECK(packed.begin() == packed.end());
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright(c) 2017 https://github.com/mrprint
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.
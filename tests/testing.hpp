@@ -0,0 +1,163 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <vector>
+#include <queue>
+#include <random>
+#include <utility>
+#include <functional>
+#include "gridpolicies.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// Проверки без сторонних библиотек
+// TEST_CASE регистрирует проверку в группе. Запуск без аргументов выполняет
+// все группы, иначе - лишь перечисленные (так их вызывает ctest). CHECK не
+// прерывает проверку: нарушение печатается и засчитывается как провал.
+// Здесь же - карта, эталонный поиск и проход по найденному пути для сверки.
+////////////////////////////////////////////////////////////////////////////////
+
+namespace testing
+{
+
+    struct Case
+    {
+        const char *group, *name;
+        void (*body)();
+    };
+
+    std::vector<Case>& cases();
+    void failure(const char *file, int line, const char *expr);
+
+    struct Registrar
+    {
+        Registrar(const char *group, const char *name, void (*body)()) { cases().push_back(Case{ group, name, body }); }
+    };
+
+    struct Coords { int x, y; };
+
+    inline bool operator== (const Coords& a, const Coords& b) { return a.x == b.x && a.y == b.y; }
+
+    // Квадратная карта N x N, изначально пустая
+    template <std::size_t N>
+    struct Map
+    {
+        std::vector<unsigned char> cells = std::vector<unsigned char>(N * N, 0);
+
+        bool isobstacle(int x, int y) const { return cells[y * N + x] != 0; }
+        void set(int x, int y, bool obstacle) { cells[y * N + x] = obstacle ? 1 : 0; }
+        void flip(int x, int y) { cells[y * N + x] ^= 1; }
+
+        // Случайные препятствия с плотностью density
+        void scatter(std::mt19937& rnd, double density)
+        {
+            std::bernoulli_distribution d(density);
+            for (auto& c : cells)
+                c = d(rnd) ? 1 : 0;
+        }
+
+        Coords any_cell(std::mt19937& rnd) const
+        {
+            return Coords{ static_cast<int>(rnd() % N), static_cast<int>(rnd() % N) };
+        }
+
+        // Случайная клетка, освобождаемая при необходимости
+        Coords free_cell(std::mt19937& rnd)
+        {
+            Coords p = any_cell(rnd);
+            set(p.x, p.y, false);
+            return p;
+        }
+    };
+
+    // Эталон: стоимости кратчайших путей из from во все клетки по алгоритму
+    // Дейкстры при 8-связности со срезанием углов; -1 - клетка недостижима.
+    // Пути симметричны, так что это и стоимости путей в from
+    template <std::size_t N>
+    std::vector<int> distances(const Map<N>& map, const Coords& from)
+    {
+        std::vector<int> dist(N * N, -1);
+        using Item = std::pair<int, int>;
+        std::priority_queue<Item, std::vector<Item>, std::greater<Item>> opened;
+        dist[from.y * N + from.x] = 0;
+        opened.push(Item(0, static_cast<int>(from.y * N + from.x)));
+        while (!opened.empty())
+        {
+            const Item top = opened.top();
+            opened.pop();
+            if (top.first > dist[top.second])
+                continue;
+            const int x = top.second % static_cast<int>(N), y = top.second / static_cast<int>(N);
+            for (int dy = -1; dy <= 1; ++dy)
+                for (int dx = -1; dx <= 1; ++dx)
+                {
+                    const int nx = x + dx, ny = y + dy;
+                    if ((dx == 0 && dy == 0) || nx < 0 || ny < 0 || nx >= static_cast<int>(N) || ny >= static_cast<int>(N)
+                        || map.isobstacle(nx, ny))
+                        continue;
+                    const int cost = top.first + (dx != 0 && dy != 0 ? tool::GRID_DIAG_COST : tool::GRID_STEP_COST);
+                    int& d = dist[ny * N + nx];
+                    if (d < 0 || cost < d)
+                    {
+                        d = cost;
+                        opened.push(Item(cost, ny * static_cast<int>(N) + nx));
+                    }
+                }
+        }
+        return dist;
+    }
+
+    template <std::size_t N>
+    int distance(const std::vector<int>& dist, const Coords& p) { return dist[p.y * N + p.x]; }
+
+    // Проход от start по смещениям в обратном порядке (формат AStar).
+    // Стоимость пути или -1, если шаг не единичный или ведёт в препятствие;
+    // в end - клетка, где путь закончился
+    template <std::size_t N, typename TPath>
+    int walk(const Map<N>& map, const Coords& start, const TPath& path, Coords& end)
+    {
+        int cost = 0;
+        end = start;
+        for (auto it = path.rbegin(); it != path.rend(); ++it)
+        {
+            if (std::abs(it->x) > 1 || std::abs(it->y) > 1 || (it->x == 0 && it->y == 0))
+                return -1;
+            end.x += it->x;
+            end.y += it->y;
+            if (end.x < 0 || end.y < 0 || end.x >= static_cast<int>(N) || end.y >= static_cast<int>(N)
+                || map.isobstacle(end.x, end.y))
+                return -1;
+            cost += it->x != 0 && it->y != 0 ? tool::GRID_DIAG_COST : tool::GRID_STEP_COST;
+        }
+        return cost;
+    }
+
+}
+
+#define TEST_CASE(group, name) \
+    static void test_##group##_##name(); \
+    static const testing::Registrar registrar_##group##_##name(#group, #name, test_##group##_##name); \
+    static void test_##group##_##name()
+
+#define CHECK(expr) ((expr) ? (void)0 : testing::failure(__FILE__, __LINE__, #expr))
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright(c) 2017 https://github.com/mrprint
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal 
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in 
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+// SOFTWARE.